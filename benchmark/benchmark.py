@@ -320,6 +320,8 @@ def bench_pw_mt(number: int, n_thread: int, globals: dict) -> None:
 
 
 def main(number=64, n_thread=4):
+    is_gil_enabled = getattr(sys, "_is_gil_enabled", lambda: True)()
+    print(f"python: {sys.version}, GIL enabled: {is_gil_enabled}")  # noqa: T201
     wav, fs = test_wave()
     data = {"wav": wav, "fs": fs}
     bench_wwopy(number, data)
@@ -0,0 +1,209 @@
+"""Performance tests. They are not part of the default test run.
+
+Run them on an otherwise idle machine:
+
+    python -m pytest benchmark
+
+The allocation tests need an extension built with
+-DWWOPY_COUNT_ALLOCATIONS=ON and are skipped otherwise.
+"""
+
+from __future__ import annotations
+
+import os
+import time
+from pathlib import Path
+from typing import Any, Callable
+
+import numpy as np
+import pytest
+
+import wwopy
+from wwopy.corpus import read_wav
+
+_TEST_FILE = Path(__file__).parents[1] / "vendored/World/test/vaiueo2d.wav"
+
+# Functions that take n_threads. Keys of the functions fixture.
+THREADED_FUNCTIONS = [
+    "dio",
+    "harvest",
+    "dio_harvest",
+    "stonemask",
+    "cheaptrick",
+    "d4c",
+    "code_spectral_envelope",
+    "decode_spectral_envelope",
+    "code_aperiodicity",
+    "decode_aperiodicity",
+    "time_stretch",
+    "resample",
+]
+# synthesis() only runs on the calling thread.
+ALL_FUNCTIONS = [*THREADED_FUNCTIONS, "synthesis"]
+
+# Speedups measured by test_scaling.py, printed after the run.
+_speedups: dict[str, list[float]] = {}
+
+
+def pytest_addoption(parser: pytest.Parser) -> None:
+    group = parser.getgroup("wwopy performance")
+    group.addoption(
+        "--perf-threads",
+        type=int,
+        default=min(os.cpu_count() or 1, 4),
+        help="Largest number of threads to measure. Defaults to min(cpus, 4).",
+    )
+    group.addoption(
+        "--min-efficiency",
+        type=float,
+        default=0.5,
+        help="Minimum speedup with N threads divided by N.",
+    )
+    group.addoption(
+        "--perf-repeat",
+        type=int,
+        default=5,
+        help="Timing repetitions. The best one is used.",
+    )
+    group.addoption(
+        "--allocation-tolerance",
+        type=float,
+        default=0.0,
+        help="Allowed relative increase over the allocation baseline.",
+    )
+    group.addoption(
+        "--max-append-allocations-per-frame",
+        type=float,
+        default=2.0,
+        help="Allocations per frame allowed in RealtimeSynthesizer.append().",
+    )
+    group.addoption(
+        "--max-synthesis-allocations",
+        type=int,
+        default=1,
+        help="Allocations allowed in each RealtimeSynthesizer.synthesis() call.",
+    )
+    group.addoption(
+        "--max-resample-allocation-growth",
+        type=int,
+        default=0,
+        help="Extra allocations allowed when resample() gets a 4 times longer signal.",
+    )
+    group.addoption(
+        "--update-allocation-baseline",
+        action="store_true",
+        help="Record the allocation counts instead of checking them.",
+    )
+
+
+def pytest_generate_tests(metafunc: pytest.Metafunc) -> None:
+    if "threaded_function" in metafunc.fixturenames:
+        metafunc.parametrize("threaded_function", THREADED_FUNCTIONS)
+    if "any_function" in metafunc.fixturenames:
+        metafunc.parametrize("any_function", ALL_FUNCTIONS)
+
+
+def pytest_terminal_summary(terminalreporter: Any) -> None:
+    if not _speedups:
+        return
+    terminalreporter.section("speedup over 1 thread")
+    for name, speedups in _speedups.items():
+        row = " ".join(f"{s:5.2f}" for s in speedups)
+        terminalreporter.write_line(f"{name:<36} {row}")
+
+
+@pytest.fixture
+def speedups() -> dict[str, list[float]]:
+    """Speedups by function name, printed at the end of the run."""
+    return _speedups
+
+
+@pytest.fixture
+def best_time(request: pytest.FixtureRequest) -> Callable[[Callable[[], Any]], float]:
+    """Best wall time of --perf-repeat calls, after one warm-up call."""
+    repeat = request.config.getoption("--perf-repeat")
+
+    def measure(func: Callable[[], Any]) -> float:
+        func()
+        best = float("inf")
+        for _ in range(repeat):
+            start = time.perf_counter()
+            func()
+            best = min(best, time.perf_counter() - start)
+        return best
+
+    return measure
+
+
+@pytest.fixture(scope="session")
+def signal() -> tuple[np.ndarray[tuple[int], np.dtype[np.double]], int]:
+    x, fs = read_wav(_TEST_FILE)
+    # Long enough that every thread gets many frames.
+    return np.tile(x, 4), fs
+
+
+@pytest.fixture(scope="session")
+def analysis(
+    signal: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+) -> dict[str, Any]:
+    x, fs = signal
+    n_threads = os.cpu_count() or 1
+    temporal_positions, f0, frame_period = wwopy.harvest(x, fs)
+    spectrogram, fft_size = wwopy.cheaptrick(
+        x, fs, temporal_positions, f0, n_threads=n_threads
+    )
+    aperiodicity = wwopy.d4c(
+        x, fs, temporal_positions, f0, fft_size, n_threads=n_threads
+    )
+    return {
+        "temporal_positions": temporal_positions,
+        "f0": f0,
+        "frame_period": frame_period,
+        "spectrogram": spectrogram,
+        "fft_size": fft_size,
+        "aperiodicity": aperiodicity,
+    }
+
+
+@pytest.fixture(scope="session")
+def functions(
+    pytestconfig: pytest.Config,
+    signal: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    analysis: dict[str, Any],
+) -> dict[str, Callable[[int], Any]]:
+    """Calls of ALL_FUNCTIONS with the given n_threads.
+
+    synthesis ignores n_threads. dio and harvest only run channels in
+    parallel, so they analyze one channel per thread.
+    """
+    x, fs = signal
+    channels = np.tile(x, (pytestconfig.getoption("--perf-threads"), 1))
+    tp = analysis["temporal_positions"]
+    f0 = analysis["f0"]
+    frame_period = analysis["frame_period"]
+    sp = analysis["spectrogram"]
+    ap = analysis["aperiodicity"]
+    fft_size = analysis["fft_size"]
+    coded_sp = wwopy.code_spectral_envelope(sp, fs, 40)
+    coded_ap = wwopy.code_aperiodicity(ap, fs)
+    return {
+        "dio": lambda n: wwopy.dio(channels, fs, n_threads=n),
+        "harvest": lambda n: wwopy.harvest(channels, fs, n_threads=n),
+        "dio_harvest": lambda n: wwopy.dio_harvest(x, fs, n_threads=n),
+        "stonemask": lambda n: wwopy.stonemask(x, fs, tp, f0, n_threads=n),
+        "cheaptrick": lambda n: wwopy.cheaptrick(x, fs, tp, f0, n_threads=n),
+        "d4c": lambda n: wwopy.d4c(x, fs, tp, f0, fft_size, n_threads=n),
+        "code_spectral_envelope": lambda n: wwopy.code_spectral_envelope(
+            sp, fs, 40, n_threads=n
+        ),
+        "decode_spectral_envelope": lambda n: wwopy.decode_spectral_envelope(
+            coded_sp, fs, fft_size, n_threads=n
+        ),
+        "code_aperiodicity": lambda n: wwopy.code_aperiodicity(ap, fs, n_threads=n),
+        "decode_aperiodicity": lambda n: wwopy.decode_aperiodicity(
+            coded_ap, fs, fft_size, n_threads=n
+        ),
+        "time_stretch": lambda n: wwopy.time_stretch(f0, sp, ap, 1.5, n_threads=n),
+        "resample": lambda n: wwopy.resample(x, fs, 44100, n_threads=n),
+        "synthesis": lambda _: wwopy.synthesis(f0, sp, ap, frame_period, fs),
+    }
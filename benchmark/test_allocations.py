@@ -0,0 +1,140 @@
+from __future__ import annotations
+
+import json
+from pathlib import Path
+from typing import Any, Callable
+
+import numpy as np
+import pytest
+
+import wwopy
+from wwopy import wwopy_ext  # type: ignore[reportMissingModuleSource]
+
+# Exact counts of a single-threaded call, recorded with
+# --update-allocation-baseline and committed. They depend on the compiler
+# and the standard library, so the CI toolchain is the reference.
+_BASELINE_FILE = Path(__file__).with_name("allocation_baseline.json")
+
+
+@pytest.fixture(scope="module")
+def allocation_count() -> Callable[[], int]:
+    count = getattr(wwopy_ext, "_allocation_count", None)
+    if count is None:
+        pytest.skip("wwopy was not built with WWOPY_COUNT_ALLOCATIONS.")
+    before = count()
+    wwopy.resample(np.zeros(16), 16000, 8000)
+    if count() == before:
+        pytest.skip("operator new of the extension is not interposed.")
+    return count
+
+
+@pytest.fixture(scope="module")
+def count_allocations(
+    allocation_count: Callable[[], int],
+) -> Callable[[Callable[[], Any]], int]:
+    """Allocations of a call, after one warm-up call."""
+
+    def measure(func: Callable[[], Any]) -> int:
+        func()
+        before = allocation_count()
+        func()
+        return allocation_count() - before
+
+    return measure
+
+
+def test_allocation_baseline(
+    request: pytest.FixtureRequest,
+    any_function: str,
+    functions: dict[str, Callable[[int], Any]],
+    count_allocations: Callable[[Callable[[], Any]], int],
+):
+    """A call must not allocate more than when the baseline was recorded."""
+    count = count_allocations(lambda: functions[any_function](1))
+    baseline = json.loads(_BASELINE_FILE.read_text()) if _BASELINE_FILE.exists() else {}
+    if request.config.getoption("--update-allocation-baseline"):
+        baseline[any_function] = count
+        _BASELINE_FILE.write_text(json.dumps(baseline, indent=2, sort_keys=True))
+        return
+    if any_function not in baseline:
+        pytest.fail(
+            f"{any_function}: no allocation baseline. "
+            "Record it with --update-allocation-baseline and commit it."
+        )
+    tolerance = request.config.getoption("--allocation-tolerance")
+    limit = baseline[any_function] * (1.0 + tolerance)
+    assert count <= limit, (
+        f"{any_function}: {count} allocations, baseline {baseline[any_function]}."
+    )
+
+
+def test_resample_allocations_do_not_depend_on_length(
+    request: pytest.FixtureRequest,
+    signal: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    count_allocations: Callable[[Callable[[], Any]], int],
+):
+    x, fs = signal
+    short = count_allocations(lambda: wwopy.resample(x[: len(x) // 4], fs, 44100))
+    long = count_allocations(lambda: wwopy.resample(x, fs, 44100))
+    growth = request.config.getoption("--max-resample-allocation-growth")
+    assert long - short <= growth, f"{short} -> {long} allocations."
+
+
+def _append_allocations(
+    analysis: dict[str, Any],
+    fs: int,
+    frames: int,
+    allocation_count: Callable[[], int],
+) -> int:
+    synthesizer = wwopy.RealtimeSynthesizer(
+        fs, analysis["frame_period"], analysis["fft_size"], 64, frames + 2
+    )
+    f0 = analysis["f0"][:frames]
+    spectrogram = analysis["spectrogram"][:frames]
+    aperiodicity = analysis["aperiodicity"][:frames]
+    before = allocation_count()
+    assert synthesizer.append(f0, spectrogram, aperiodicity)
+    return allocation_count() - before
+
+
+def test_append_allocations_per_frame(
+    request: pytest.FixtureRequest,
+    signal: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    analysis: dict[str, Any],
+    allocation_count: Callable[[], int],
+):
+    """World takes ownership of every frame, so append() allocates a
+    spectrogram and an aperiodicity array per frame. Nothing else may be
+    allocated per frame."""
+    _x, fs = signal
+    frames = 64
+    one = _append_allocations(analysis, fs, 1, allocation_count)
+    many = _append_allocations(analysis, fs, frames, allocation_count)
+    per_frame = (many - one) / (frames - 1)
+    limit = request.config.getoption("--max-append-allocations-per-frame")
+    assert per_frame <= limit, f"{per_frame:.2f} allocations per frame."
+
+
+def test_realtime_synthesis_allocations_are_constant(
+    request: pytest.FixtureRequest,
+    signal: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    analysis: dict[str, Any],
+    allocation_count: Callable[[], int],
+):
+    """The allocations of a call do not grow with the length of the stream.
+    By default only the returned buffer may be allocated."""
+    _x, fs = signal
+    f0 = analysis["f0"]
+    synthesizer = wwopy.RealtimeSynthesizer(
+        fs, analysis["frame_period"], analysis["fft_size"], 64, len(f0) + 2
+    )
+    assert synthesizer.append(f0, analysis["spectrogram"], analysis["aperiodicity"])
+    counts = []
+    for _ in range(32):
+        before = allocation_count()
+        if synthesizer.synthesis() is None:
+            break
+        counts.append(allocation_count() - before)
+    assert counts
+    limit = request.config.getoption("--max-synthesis-allocations")
+    assert max(counts) <= limit, counts
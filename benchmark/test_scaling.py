@@ -0,0 +1,77 @@
+from __future__ import annotations
+
+import threading
+from typing import Any, Callable
+
+import pytest
+
+from wwopy import wwopy_ext  # type: ignore[reportMissingModuleSource]
+
+# Functions that draw from World's randn(). Unless World keeps its state per
+# thread, wwopy runs their World calls one at a time.
+_RANDN_FUNCTIONS = {"cheaptrick", "d4c", "synthesis"}
+
+
+def _threads(request: pytest.FixtureRequest) -> int:
+    n_threads = request.config.getoption("--perf-threads")
+    if n_threads < 2:
+        pytest.skip("needs at least 2 threads.")
+    return n_threads
+
+
+def _skip_serialized(name: str) -> None:
+    thread_safe = getattr(wwopy_ext, "_world_randn_is_thread_safe", None)
+    if name in _RANDN_FUNCTIONS and not (thread_safe and thread_safe()):
+        pytest.skip("built without WWOPY_WORLD_THREAD_SAFE_RANDN.")
+
+
+def test_thread_scaling(
+    request: pytest.FixtureRequest,
+    threaded_function: str,
+    functions: dict[str, Callable[[int], Any]],
+    best_time: Callable[[Callable[[], Any]], float],
+    speedups: dict[str, list[float]],
+):
+    """n_threads=N must be close to N times faster than n_threads=1."""
+    n_threads = _threads(request)
+    _skip_serialized(threaded_function)
+    min_efficiency = request.config.getoption("--min-efficiency")
+    func = functions[threaded_function]
+    times = [best_time(lambda n=n: func(n)) for n in range(1, n_threads + 1)]
+    result = [times[0] / t for t in times]
+    speedups[threaded_function] = result
+    assert result[-1] >= min_efficiency * n_threads, (
+        f"{threaded_function}: {result[-1]:.2f}x with {n_threads} threads."
+    )
+
+
+def test_gil_released(
+    request: pytest.FixtureRequest,
+    any_function: str,
+    functions: dict[str, Callable[[int], Any]],
+    best_time: Callable[[Callable[[], Any]], float],
+    speedups: dict[str, list[float]],
+):
+    """Calls from N Python threads must run in parallel.
+
+    A call that holds the GIL, or that serializes on a lock, while it
+    computes runs at the speed of a single thread.
+    """
+    n_threads = _threads(request)
+    _skip_serialized(any_function)
+    min_efficiency = request.config.getoption("--min-efficiency")
+    func = functions[any_function]
+
+    def concurrent() -> None:
+        threads = [threading.Thread(target=func, args=(1,)) for _ in range(n_threads)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+    single = best_time(lambda: func(1))
+    speedup = n_threads * single / best_time(concurrent)
+    speedups[f"{any_function} (threads)"] = [speedup]
+    assert speedup >= min_efficiency * n_threads, (
+        f"{any_function}: {speedup:.2f}x from {n_threads} Python threads."
+    )
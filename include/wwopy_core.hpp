@@ -0,0 +1,382 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+// C++ interface of wwopy. It does not depend on Python, so it can be linked
+// into native programs through the wwopy_core target. The Python extension
+// is built on top of it.
+
+#ifndef WWOPY_INCLUDE_WWOPY_CORE_HPP_
+#define WWOPY_INCLUDE_WWOPY_CORE_HPP_
+
+#include <world/cheaptrick.h>
+#include <world/d4c.h>
+#include <world/dio.h>
+#include <world/harvest.h>
+#include <world/synthesisrealtime.h>
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace wwopy {
+
+void validate_fs(int fs);
+void validate_x_length(size_t x_length);
+// Returns the FFT size of a spectrum with length bins.
+auto restore_fft_size(size_t length) -> int;
+
+// Options left empty keep the defaults of World.
+struct DioOptions {
+  std::optional<double> f0_floor;
+  std::optional<double> f0_ceil;
+  std::optional<double> channels_in_octave;
+  std::optional<double> frame_period;
+  std::optional<int> speed;
+  std::optional<double> allowed_range;
+};
+
+struct HarvestOptions {
+  std::optional<double> f0_floor;
+  std::optional<double> f0_ceil;
+  std::optional<double> frame_period;
+};
+
+struct CheapTrickOptions {
+  std::optional<double> q1;
+  // Ignored when fft_size is set.
+  std::optional<double> f0_floor;
+  std::optional<int> fft_size;
+};
+
+struct D4COptions {
+  std::optional<double> threshold;
+};
+
+// These validate the options and throw std::invalid_argument.
+auto make_dio_option(const DioOptions& options) -> DioOption;
+auto make_harvest_option(const HarvestOptions& options) -> HarvestOption;
+auto make_cheaptrick_option(int fs, const CheapTrickOptions& options)
+    -> CheapTrickOption;
+auto make_d4c_option(const D4COptions& options) -> D4COption;
+
+auto get_fft_size_from_f0_floor(int fs, std::optional<double> f0_floor)
+    -> int;
+
+// False while World shares the randn() state between threads. CheapTrick,
+// D4C and synthesis then run one World call at a time, whatever n_threads
+// is. Build with WWOPY_WORLD_THREAD_SAFE_RANDN when World keeps that state
+// per thread.
+auto world_randn_is_thread_safe() -> bool;
+
+// Row-major matrix that also provides the row pointers World expects.
+class Matrix {
+ public:
+  Matrix() = default;
+  Matrix(size_t rows, size_t columns);
+  Matrix(const Matrix& other);
+  Matrix(Matrix&& other) noexcept = default;
+  auto operator=(const Matrix& other) -> Matrix&;
+  auto operator=(Matrix&& other) noexcept -> Matrix& = default;
+  ~Matrix() = default;
+
+  // Keeps the allocation when it is large enough.
+  void resize(size_t rows, size_t columns);
+
+  auto rows() const -> size_t { return row_count; }
+  auto columns() const -> size_t { return column_count; }
+  auto data() -> double* { return values.data(); }
+  auto data() const -> const double* { return values.data(); }
+  auto row(size_t i) -> double* { return pointers[i]; }
+  auto row(size_t i) const -> const double* { return pointers[i]; }
+  auto row_pointers() -> double** { return pointers.data(); }
+  auto row_pointers() const -> const double* const* {
+    return pointers.data();
+  }
+
+ private:
+  size_t row_count = 0;
+  size_t column_count = 0;
+  std::vector<double> values;
+  std::vector<double*> pointers;
+
+  void update_pointers();
+};
+
+// Signals read through strides, such as one channel of interleaved
+// samples. Sample j of channel c is
+// data[c * channel_stride + j * sample_stride].
+struct StridedSignals {
+  const double* data;
+  size_t channels;
+  size_t length;
+  std::ptrdiff_t channel_stride;
+  std::ptrdiff_t sample_stride;
+};
+
+// Decodes coded aperiodicity with World's DecodeAperiodicity.
+void decode_aperiodicity(
+    const double* const* coded_aperiodicity,
+    size_t f0_length,
+    int fs,
+    int fft_size,
+    size_t n_threads,
+    double* aperiodicity
+);
+
+// Analysis stages shared by the Python extension and Analyzer. They take
+// validated options and write to buffers owned by the caller. A batch of
+// signals is given as x[channel] and f0[channel]. Frame i of a channel is
+// row channel * f0_length + i of a matrix output.
+
+// Runs Dio on the whole of x. temporal_positions and f0 hold
+// GetSamplesForDIO() frames.
+void dio(
+    const double* x,
+    size_t x_length,
+    int fs,
+    const DioOption& option,
+    double* temporal_positions,
+    double* f0
+);
+
+// Runs Harvest on the whole of x. temporal_positions and f0 hold
+// GetSamplesForHarvest() frames.
+void harvest(
+    const double* x,
+    size_t x_length,
+    int fs,
+    const HarvestOption& option,
+    double* temporal_positions,
+    double* f0
+);
+
+// Refines the F0 of Dio with StoneMask. Frames of all channels are split
+// between threads, and the result does not depend on n_threads.
+void stonemask(
+    const double* const* x,
+    size_t channels,
+    size_t x_length,
+    int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    size_t f0_length,
+    size_t n_threads,
+    double* refined_f0
+);
+
+// Same as above for signals read through strides. The overloads of
+// cheaptrick() and d4c() below work the same way. A channel whose samples
+// are adjacent is passed to World whole. Otherwise only the samples around
+// each block of frames are gathered, so a view of a long recording is never
+// copied whole. The temporal positions are then shifted to the gathered
+// samples, which can change the result in the last bits.
+void stonemask(
+    const StridedSignals& x,
+    int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    size_t f0_length,
+    size_t n_threads,
+    double* refined_f0
+);
+
+// Writes the spectral envelope of every frame, or its coded form with
+// coded_dim columns. The result does not depend on n_threads.
+void cheaptrick(
+    const double* const* x,
+    size_t channels,
+    size_t x_length,
+    int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    size_t f0_length,
+    const CheapTrickOption& option,
+    std::optional<int> coded_dim,
+    size_t n_threads,
+    double** spectrogram
+);
+
+void cheaptrick(
+    const StridedSignals& x,
+    int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    size_t f0_length,
+    const CheapTrickOption& option,
+    std::optional<int> coded_dim,
+    size_t n_threads,
+    double** spectrogram
+);
+
+// Writes the aperiodicity of every frame, or the band-aperiodicity when
+// coded is true. The result does not depend on n_threads.
+void d4c(
+    const double* const* x,
+    size_t channels,
+    size_t x_length,
+    int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    size_t f0_length,
+    int fft_size,
+    const D4COption& option,
+    bool coded,
+    size_t n_threads,
+    double** aperiodicity
+);
+
+void d4c(
+    const StridedSignals& x,
+    int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    size_t f0_length,
+    int fft_size,
+    const D4COption& option,
+    bool coded,
+    size_t n_threads,
+    double** aperiodicity
+);
+
+enum class F0Method {
+  // Dio refined by StoneMask.
+  dio,
+  harvest,
+};
+
+struct AnalyzerOptions {
+  F0Method f0_method = F0Method::harvest;
+  DioOptions dio;
+  HarvestOptions harvest;
+  CheapTrickOptions cheaptrick;
+  D4COptions d4c;
+};
+
+struct Analysis {
+  std::vector<double> temporal_positions;
+  std::vector<double> f0;
+  Matrix spectrogram;
+  Matrix aperiodicity;
+  double frame_period = 0.0;
+  int fft_size = 0;
+};
+
+// Runs F0 estimation, CheapTrick and D4C with options validated once.
+// The result and the scratch buffers are reused by the next call. World
+// still allocates its own work buffers inside every call.
+class Analyzer {
+ public:
+  Analyzer(int fs, const AnalyzerOptions& options, size_t n_threads = 1);
+
+  auto analyze(const double* x, size_t x_length) -> const Analysis&;
+
+ private:
+  struct Settings {
+    int fs;
+    F0Method f0_method;
+    DioOption dio;
+    HarvestOption harvest;
+    CheapTrickOption cheaptrick;
+    D4COption d4c;
+  };
+
+  Settings settings;
+  size_t n_threads;
+  Analysis result;
+  // F0 of Dio before StoneMask.
+  std::vector<double> raw_f0;
+
+  static auto make_settings(int fs, const AnalyzerOptions& options)
+      -> Settings;
+  static void run(
+      const Settings& settings,
+      const double* x,
+      size_t x_length,
+      size_t n_threads,
+      std::vector<double>& raw_f0,
+      Analysis& result
+  );
+
+  friend class BatchAnalyzer;
+};
+
+// Analyzes signals of the same length in parallel, one per thread.
+// Every channel gets the result of Analyzer with n_threads = 1. Threads
+// left over when there are fewer channels only split the frames of
+// StoneMask, CheapTrick and D4C, whose results do not depend on them.
+class BatchAnalyzer {
+ public:
+  BatchAnalyzer(int fs, const AnalyzerOptions& options, size_t n_threads);
+
+  auto analyze(const double* const* x, size_t channels, size_t x_length)
+      -> const std::vector<Analysis>&;
+
+ private:
+  Analyzer::Settings settings;
+  size_t n_threads;
+  std::vector<Analysis> results;
+  std::vector<std::vector<double>> raw_f0;
+};
+
+// Number of samples synthesized from f0_length frames.
+auto synthesis_length(size_t f0_length, double frame_period, int fs)
+    -> size_t;
+
+// Writes synthesis_length(f0_length, frame_period, fs) samples to y.
+// fft_size is derived from spectrum_length.
+void synthesis(
+    const double* f0,
+    size_t f0_length,
+    const double* const* spectrogram,
+    const double* const* aperiodicity,
+    size_t spectrum_length,
+    double frame_period,
+    int fs,
+    double* y
+);
+
+// World's realtime synthesizer. The parameters are copied when appended.
+// All methods may be called from several threads at once.
+class RealtimeSynthesizer {
+ public:
+  RealtimeSynthesizer(
+      int fs,
+      double frame_period,
+      int fft_size,
+      int buffer_size,
+      int number_of_pointers
+  );
+  RealtimeSynthesizer(const RealtimeSynthesizer&) = delete;
+  RealtimeSynthesizer(RealtimeSynthesizer&&) = delete;
+  auto operator=(const RealtimeSynthesizer&) -> RealtimeSynthesizer& = delete;
+  auto operator=(RealtimeSynthesizer&&) -> RealtimeSynthesizer& = delete;
+  ~RealtimeSynthesizer();
+
+  // Returns false when the ring buffer is full. World takes ownership of
+  // every frame, so each call allocates the F0 copy and the two row
+  // arrays, plus two arrays (spectrogram and aperiodicity) per frame.
+  auto append(
+      const double* f0,
+      size_t f0_length,
+      const double* const* spectrogram,
+      const double* const* aperiodicity,
+      size_t spectrum_length
+  ) -> bool;
+  auto locked() -> bool;
+  // Writes buffer_size() samples to y. Returns false when not enough
+  // parameters have been appended.
+  auto synthesis(double* y) -> bool;
+  void refresh();
+  auto buffer_size() const -> size_t;
+
+ private:
+  WorldSynthesizer synthesizer;
+  std::mutex mutex;
+};
+
+}  // namespace wwopy
+
+#endif
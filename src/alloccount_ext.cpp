@@ -0,0 +1,200 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+// Built only with WWOPY_COUNT_ALLOCATIONS. Replaces the global allocation
+// functions of the extension, World included, so that the performance
+// tests in benchmark/ can count heap allocations per call. Memory of the
+// interpreter and of other extensions is not counted.
+
+#include "wwopy_init.hpp"
+
+#include <nanobind/nanobind.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace nb = nanobind;
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+auto counted_malloc(const size_t size) noexcept -> void* {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+auto counted_new(const size_t size) -> void* {
+  void* p = counted_malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+// Over-aligned types (alignas larger than std::max_align_t) use these.
+auto counted_aligned_malloc(
+    size_t size,
+    const std::align_val_t alignment
+) noexcept -> void* {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  const auto align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+  return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+  // std::aligned_alloc needs a size that is a multiple of the alignment.
+  size = (size + align - 1) / align * align;
+  return std::aligned_alloc(align, size == 0 ? align : size);
+#endif
+}
+
+auto counted_aligned_new(const size_t size, const std::align_val_t alignment)
+    -> void* {
+  void* p = counted_aligned_malloc(size, alignment);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void aligned_free(void* p) noexcept {
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+}  // namespace
+
+auto operator new(size_t size) -> void* {
+  return counted_new(size);
+}
+
+auto operator new[](size_t size) -> void* {
+  return counted_new(size);
+}
+
+auto operator new(size_t size, const std::nothrow_t& /*unused*/) noexcept
+    -> void* {
+  return counted_malloc(size);
+}
+
+auto operator new[](size_t size, const std::nothrow_t& /*unused*/) noexcept
+    -> void* {
+  return counted_malloc(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t /*unused*/) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, size_t /*unused*/) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t& /*unused*/) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t& /*unused*/) noexcept {
+  std::free(p);
+}
+
+auto operator new(size_t size, std::align_val_t alignment) -> void* {
+  return counted_aligned_new(size, alignment);
+}
+
+auto operator new[](size_t size, std::align_val_t alignment) -> void* {
+  return counted_aligned_new(size, alignment);
+}
+
+auto operator new(
+    size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t& /*unused*/
+) noexcept -> void* {
+  return counted_aligned_malloc(size, alignment);
+}
+
+auto operator new[](
+    size_t size,
+    std::align_val_t alignment,
+    const std::nothrow_t& /*unused*/
+) noexcept -> void* {
+  return counted_aligned_malloc(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t /*unused*/) noexcept {
+  aligned_free(p);
+}
+
+void operator delete[](void* p, std::align_val_t /*unused*/) noexcept {
+  aligned_free(p);
+}
+
+void operator delete(
+    void* p,
+    size_t /*unused*/,
+    std::align_val_t /*unused*/
+) noexcept {
+  aligned_free(p);
+}
+
+void operator delete[](
+    void* p,
+    size_t /*unused*/,
+    std::align_val_t /*unused*/
+) noexcept {
+  aligned_free(p);
+}
+
+void operator delete(
+    void* p,
+    std::align_val_t /*unused*/,
+    const std::nothrow_t& /*unused*/
+) noexcept {
+  aligned_free(p);
+}
+
+void operator delete[](
+    void* p,
+    std::align_val_t /*unused*/,
+    const std::nothrow_t& /*unused*/
+) noexcept {
+  aligned_free(p);
+}
+
+void alloccount_init(nb::module_& m) {
+  m.def(
+      "_allocation_count",
+      []() -> size_t {
+        return allocation_count.load(std::memory_order_relaxed);
+      },
+      R"(
+      Returns the number of heap allocations made by the extension so far.
+
+      Only available when built with WWOPY_COUNT_ALLOCATIONS.
+      Used by the performance tests.
+
+      Returns
+      -------
+      int)"
+  );
+}
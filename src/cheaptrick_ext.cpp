@@ -7,140 +7,138 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
 #include <world/cheaptrick.h>
 
 #include <cstddef>
-#include <limits>
 #include <memory>
 #include <optional>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "parallel.hpp"
 #include "util.hpp"
+#include "wwopy_core.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
 namespace {
 
+template <size_t N>
 auto cheaptrick(
-    const util::inputNDarray<1>& x,
+    const util::inputNDarray<N>& x,
     const int fs,
     const util::inputNDarray<1>& temporal_positions,
-    const util::inputNDarray<1>& f0,
+    const util::inputNDarray<N>& f0,
     const std::optional<double> q1,
     const std::optional<double> f0_floor,
-    const std::optional<int> fft_size
+    const std::optional<int> fft_size,
+    const std::optional<int> coded_dim,
+    const std::optional<int> n_threads,
+    const std::string& framework
 ) {
-  util::validate_x_lenth(x.size());
-  util::validate_fs(fs);
-  if (temporal_positions.size() != f0.size()) {
+  const size_t channels = util::channel_count(x);
+  const size_t x_length = x.shape(N - 1);
+  wwopy::validate_x_length(x_length);
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  util::validate_channels(x, f0);
+  const size_t f0_length = f0.shape(N - 1);
+  if (temporal_positions.size() != f0_length) {
     throw std::invalid_argument(
         "The lengths of temporal_positions and f0 do not match."
     );
   }
-  CheapTrickOption option{};
-  InitializeCheapTrickOption(fs, &option);
-  if (q1) {
-    option.q1 = *q1;
-  }
-  if (fft_size) {
-    if (f0_floor) {
-      const nb::gil_scoped_acquire gil;
-      const nb::object warn = nb::module_::import_("warnings").attr("warn");
-      const nb::object runtimeWarning =
-          nb::module_::import_("builtins").attr("RuntimeWarning");
-      const auto* const msg =
-          "The value of f0_floor is ignored "
-          "because the value of fft_size is set.";
-      warn(msg, runtimeWarning);
-    }
-    option.fft_size = *fft_size;
-    option.f0_floor = GetF0FloorForCheapTrick(fs, *fft_size);
-    if (option.f0_floor <= 0) {
-      throw std::invalid_argument("fft_size is invalid.");
-    }
-  } else if (f0_floor) {
-    if (*f0_floor <= 0.0) {
-      throw std::invalid_argument("f0_floor must be non-negative.");
-    }
-    if (*f0_floor <
-        GetF0FloorForCheapTrick(fs, std::numeric_limits<int>::max())) {
-      throw std::invalid_argument("Determine fft_size is invalid.");
-    }
-    option.f0_floor = *f0_floor;
-    option.fft_size = GetFFTSizeForCheapTrick(fs, &option);
+  if (fft_size && f0_floor) {
+    const nb::gil_scoped_acquire gil;
+    const nb::object warn = nb::module_::import_("warnings").attr("warn");
+    const nb::object runtimeWarning =
+        nb::module_::import_("builtins").attr("RuntimeWarning");
+    const auto* const msg =
+        "The value of f0_floor is ignored "
+        "because the value of fft_size is set.";
+    warn(msg, runtimeWarning);
   }
-  if (option.fft_size <= 0) {
-    throw std::invalid_argument("fft_size must be non-negative.");
+  const CheapTrickOption option =
+      wwopy::make_cheaptrick_option(fs, {q1, f0_floor, fft_size});
+  if (coded_dim && *coded_dim <= 0) {
+    throw std::invalid_argument("coded_dim must be greater than 0.");
   }
-  const size_t f0_length = f0.size();
+  const size_t threads = util::resolve_n_threads(n_threads);
   const size_t spectrogram_length = (option.fft_size / 2) + 1;
-  if (f0_length == 0) {
+  const size_t output_length =
+      coded_dim ? static_cast<size_t>(*coded_dim) : spectrogram_length;
+  if (f0_length == 0 || channels == 0) {
     const nb::gil_scoped_acquire gil;
     return nb::make_tuple(
-        util::outputNDarray<2>(nullptr, {0, spectrogram_length}, nb::handle()),
+        util::export_batch<N>(
+            nullptr, channels, output_framework, 0, output_length
+        ),
         option.fft_size
     );
   }
-  auto spectrogram = std::make_unique<double*[]>(f0_length);
-  auto output_array =
-      std::make_unique<double[]>(f0_length * spectrogram_length);
-  for (size_t i = 0; i < f0_length; i++) {
-    spectrogram[i] = &output_array[i * spectrogram_length];
-  }
-  CheapTrick(
-      x.data(), static_cast<int>(x.size()), fs, temporal_positions.data(),
-      f0.data(), static_cast<int>(f0_length), &option, spectrogram.get()
+  const size_t frames = channels * f0_length;
+  auto output_array = std::make_unique<double[]>(frames * output_length);
+  const auto output =
+      util::make_row_pointers(output_array.get(), frames, output_length);
+  // A strided x is gathered around each block of frames by wwopy_core.
+  // Other strided inputs are gathered once. Contiguous rows are used in
+  // place.
+  std::vector<double> f0_storage;
+  std::vector<double> temporal_positions_buffer;
+  const auto f0_rows = util::InputRows<N>(f0).row_pointers(f0_storage);
+  const double* temporal_positions_data =
+      util::InputRows<1>(temporal_positions)
+          .row(0, temporal_positions_buffer);
+  wwopy::cheaptrick(
+      util::strided_signals(x), fs, temporal_positions_data, f0_rows.get(),
+      f0_length, option, coded_dim, threads, output.get()
   );
   {
     const nb::gil_scoped_acquire gil;
-    const auto result = util::make_ndarray<util::outputNDarray<2>>(
-        std::move(output_array), {f0_length, spectrogram_length}
+    return nb::make_tuple(
+        util::export_batch<N>(
+            std::move(output_array), channels, output_framework, f0_length,
+            output_length
+        ),
+        option.fft_size
     );
-    return nb::make_tuple(result, option.fft_size);
   }
 }
 
-auto get_fft_size_from_f0_floor(
-    const int fs,
-    const std::optional<double> f0_floor
-) {
-  util::validate_fs(fs);
-  CheapTrickOption option{};
-  InitializeCheapTrickOption(fs, &option);
-  if (f0_floor) {
-    if (*f0_floor <= 0.0) {
-      throw std::invalid_argument("f0_floor must be non-negative.");
-    }
-    if (*f0_floor <
-        GetF0FloorForCheapTrick(fs, std::numeric_limits<int>::max())) {
-      throw std::invalid_argument("Determine fft_size is invalid.");
-    }
-    option.f0_floor = *f0_floor;
-  }
-  return GetFFTSizeForCheapTrick(fs, &option);
-}
-
 }  // namespace
 
 void cheeptrick_init(nb::module_& m) {
   m.def(
-      "cheaptrick", &cheaptrick, "x"_a, "fs"_a, "temporal_positions"_a, "f0"_a,
-      "q1"_a = nb::none(), "f0_floor"_a = nb::none(), "fft_size"_a = nb::none(),
-      nb::call_guard<nb::gil_scoped_release>(), R"(
+      "cheaptrick", &cheaptrick<1>, "x"_a, "fs"_a, "temporal_positions"_a,
+      "f0"_a, "q1"_a = nb::none(), "f0_floor"_a = nb::none(),
+      "fft_size"_a = nb::none(), "coded_dim"_a = nb::none(), "n_threads"_a = 1,
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>(), R"(
       Calculates the spectrogram that consists of spectral envelopes.
 
+      Frames are passed to World in blocks of 64, one call per block.
+      World restarts the tiny noise it adds to the waveform on every call,
+      so from frame 64 on the result differs slightly from a single World
+      call over all frames, as wwopy returned before.
+
       Parameters
       ----------
       x : np.ndarray[tuple[int], np.dtype[np.double]]
           Input signal
+          A (channels, samples) array analyzes every channel in one call.
+          A strided view is read around each block of frames and never
+          copied whole. Its result can differ from that of a contiguous
+          copy in the last bits.
       fs : int
           Sampling frequency
       temporal_positions : np.ndarray[tuple[int], np.dtype[np.double]]
           Time axis
       f0 : np.ndarray[tuple[int], np.dtype[np.double]]
           F0 contour
+          (channels, frames) if x has channels.
       q1 : float, optional
           Used for the spectral recovery
           Since The parameter is optimized, you don't need to change the parameter.
@@ -152,11 +150,28 @@ void cheeptrick_init(nb::module_& m) {
       fft_size : int, optional
           FFT size
           This variable has precedence over f0_floor.
+      coded_dim : int, optional
+          If set, the spectrogram is coded with this number of dimensions
+          as code_spectral_envelope() does.
+          The full spectrogram is never allocated.
+      n_threads : int or None, default 1
+          Number of threads. Frames of all channels are split between threads.
+          None uses all hardware threads.
+          The result does not depend on n_threads.
+          World shares its random generator between threads, so the
+          World calls run one at a time unless wwopy is built with
+          WWOPY_WORLD_THREAD_SAFE_RANDN.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
 
       Returns
       -------
       spectrogram : np.ndarray[tuple[int, int], np.dtype[np.double]]
           Spectrogram estimated by CheapTrick.
+          Coded spectral envelope if coded_dim is set.
+          (channels, frames, bins) if x has channels.
       fft_size: int
           Automatically determined fft_size.
 
@@ -166,8 +181,15 @@ void cheeptrick_init(nb::module_& m) {
       >>> spectrogram, fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0))"
   );
   m.def(
-      "get_fft_size_from_f0_floor", &get_fft_size_from_f0_floor, "fs"_a,
-      "f0_floor"_a = nb::none(), nb::call_guard<nb::gil_scoped_release>(),
+      "cheaptrick", &cheaptrick<2>, "x"_a, "fs"_a, "temporal_positions"_a,
+      "f0"_a, "q1"_a = nb::none(), "f0_floor"_a = nb::none(),
+      "fft_size"_a = nb::none(), "coded_dim"_a = nb::none(), "n_threads"_a = 1,
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>()
+  );
+  m.def(
+      "get_fft_size_from_f0_floor", &wwopy::get_fft_size_from_f0_floor,
+      "fs"_a, "f0_floor"_a = nb::none(),
+      nb::call_guard<nb::gil_scoped_release>(),
       R"(
         Determine fft_size from f0_floor.
 
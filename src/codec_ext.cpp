@@ -0,0 +1,349 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "wwopy_init.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
+#include <world/codec.h>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "util.hpp"
+#include "wwopy_core.hpp"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace {
+
+auto code_spectral_envelope(
+    const util::inputNDarray<2>& spectrogram,
+    const int fs,
+    const int number_of_dimensions,
+    const std::optional<int> n_threads,
+    const std::string& framework
+) {
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  if (number_of_dimensions <= 0) {
+    throw std::invalid_argument("number_of_dimensions must be greater than 0.");
+  }
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t f0_length = spectrogram.shape(0);
+  const size_t spectrogram_length = spectrogram.shape(1);
+  const int fft_size = wwopy::restore_fft_size(spectrogram_length);
+  const auto coded_length = static_cast<size_t>(number_of_dimensions);
+  if (f0_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        nullptr, {0, coded_length}, output_framework
+    );
+  }
+  std::vector<double> storage;
+  const auto input = util::InputRows<2>(spectrogram).row_pointers(storage);
+  auto output_array = std::make_unique<double[]>(f0_length * coded_length);
+  const auto output =
+      util::make_row_pointers(output_array.get(), f0_length, coded_length);
+  util::parallel_for(
+      f0_length, threads, [&](const size_t begin, const size_t end) -> void {
+        CodeSpectralEnvelope(
+            &input[begin], static_cast<int>(end - begin), fs, fft_size,
+            number_of_dimensions, &output[begin]
+        );
+      }
+  );
+  {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        std::move(output_array), {f0_length, coded_length},
+        output_framework
+    );
+  }
+}
+
+auto decode_spectral_envelope(
+    const util::inputNDarray<2>& coded_spectral_envelope,
+    const int fs,
+    const int fft_size,
+    const std::optional<int> n_threads,
+    const std::string& framework
+) {
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  if (fft_size <= 0) {
+    throw std::invalid_argument("fft_size must be non-negative.");
+  }
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t f0_length = coded_spectral_envelope.shape(0);
+  const size_t coded_length = coded_spectral_envelope.shape(1);
+  if (coded_length == 0) {
+    throw std::invalid_argument("coded_spectral_envelope must not be empty.");
+  }
+  const size_t spectrogram_length = (fft_size / 2) + 1;
+  if (f0_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        nullptr, {0, spectrogram_length}, output_framework
+    );
+  }
+  std::vector<double> storage;
+  const auto input =
+      util::InputRows<2>(coded_spectral_envelope).row_pointers(storage);
+  auto output_array =
+      std::make_unique<double[]>(f0_length * spectrogram_length);
+  const auto output = util::make_row_pointers(
+      output_array.get(), f0_length, spectrogram_length
+  );
+  util::parallel_for(
+      f0_length, threads, [&](const size_t begin, const size_t end) -> void {
+        DecodeSpectralEnvelope(
+            &input[begin], static_cast<int>(end - begin), fs, fft_size,
+            static_cast<int>(coded_length), &output[begin]
+        );
+      }
+  );
+  {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        std::move(output_array), {f0_length, spectrogram_length},
+        output_framework
+    );
+  }
+}
+
+void validate_coded_aperiodicity(const size_t coded_length, const int fs) {
+  if (coded_length != static_cast<size_t>(GetNumberOfAperiodicities(fs))) {
+    throw std::invalid_argument(
+        "The length of coded_aperiodicity does not match fs."
+    );
+  }
+}
+
+auto code_aperiodicity(
+    const util::inputNDarray<2>& aperiodicity,
+    const int fs,
+    const std::optional<int> n_threads,
+    const std::string& framework
+) {
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t f0_length = aperiodicity.shape(0);
+  const size_t aperiodicity_length = aperiodicity.shape(1);
+  const int fft_size = wwopy::restore_fft_size(aperiodicity_length);
+  const auto coded_length = static_cast<size_t>(GetNumberOfAperiodicities(fs));
+  if (f0_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        nullptr, {0, coded_length}, output_framework
+    );
+  }
+  std::vector<double> storage;
+  const auto input = util::InputRows<2>(aperiodicity).row_pointers(storage);
+  auto output_array = std::make_unique<double[]>(f0_length * coded_length);
+  const auto output =
+      util::make_row_pointers(output_array.get(), f0_length, coded_length);
+  util::parallel_for(
+      f0_length, threads, [&](const size_t begin, const size_t end) -> void {
+        CodeAperiodicity(
+            &input[begin], static_cast<int>(end - begin), fs, fft_size,
+            &output[begin]
+        );
+      }
+  );
+  {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        std::move(output_array), {f0_length, coded_length},
+        output_framework
+    );
+  }
+}
+
+auto decode_aperiodicity(
+    const util::inputNDarray<2>& coded_aperiodicity,
+    const int fs,
+    const int fft_size,
+    const std::optional<int> n_threads,
+    const std::string& framework
+) {
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  if (fft_size <= 0) {
+    throw std::invalid_argument("fft_size must be non-negative.");
+  }
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t f0_length = coded_aperiodicity.shape(0);
+  const size_t coded_length = coded_aperiodicity.shape(1);
+  validate_coded_aperiodicity(coded_length, fs);
+  const size_t aperiodicity_length = (fft_size / 2) + 1;
+  if (f0_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        nullptr, {0, aperiodicity_length}, output_framework
+    );
+  }
+  auto output_array =
+      std::make_unique<double[]>(f0_length * aperiodicity_length);
+  std::vector<double> storage;
+  const auto input =
+      util::InputRows<2>(coded_aperiodicity).row_pointers(storage);
+  wwopy::decode_aperiodicity(
+      input.get(), f0_length, fs, fft_size, threads, output_array.get()
+  );
+  {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<2>(
+        std::move(output_array), {f0_length, aperiodicity_length},
+        output_framework
+    );
+  }
+}
+
+}  // namespace
+
+void codec_init(nb::module_& m) {
+  m.def(
+      "code_spectral_envelope", &code_spectral_envelope, "spectrogram"_a,
+      "fs"_a, "number_of_dimensions"_a, "n_threads"_a = 1,
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>(), R"(
+      Codes the spectral envelope.
+
+      The spectrogram is converted to mel-cepstrum based coefficients.
+
+      Parameters
+      ----------
+      spectrogram : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Spectrogram estimated by CheapTrick
+      fs : int
+          Sampling frequency
+      number_of_dimensions : int
+          Number of dimensions of the coded spectral envelope
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
+
+      Returns
+      -------
+      np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Coded spectral envelope.
+
+      Examples
+      --------
+      >>> spectrogram, fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0)
+      >>> coded_spectral_envelope = wwopy.code_spectral_envelope(spectrogram, fs, 40))"
+  );
+  m.def(
+      "decode_spectral_envelope", &decode_spectral_envelope,
+      "coded_spectral_envelope"_a, "fs"_a, "fft_size"_a,
+      "n_threads"_a = 1, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>(), R"(
+      Decodes the coded spectral envelope.
+
+      Parameters
+      ----------
+      coded_spectral_envelope : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Coded spectral envelope
+      fs : int
+          Sampling frequency
+      fft_size : int
+          FFT size of the decoded spectrogram
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
+
+      Returns
+      -------
+      np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Decoded spectrogram.
+
+      Examples
+      --------
+      >>> coded_spectral_envelope, fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0, coded_dim=40)
+      >>> spectrogram = wwopy.decode_spectral_envelope(coded_spectral_envelope, fs, fft_size))"
+  );
+  m.def(
+      "code_aperiodicity", &code_aperiodicity, "aperiodicity"_a, "fs"_a,
+      "n_threads"_a = 1, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>(), R"(
+      Codes the aperiodicity.
+
+      The aperiodicity is reduced to the band-aperiodicity.
+      The number of bands depends only on fs.
+
+      Parameters
+      ----------
+      aperiodicity : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Aperiodicity estimated by D4C
+      fs : int
+          Sampling frequency
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
+
+      Returns
+      -------
+      np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Coded aperiodicity.
+
+      Examples
+      --------
+      >>> aperiodicity = wwopy.d4c(x, fs, temporal_positions, f0, fft_size)
+      >>> coded_aperiodicity = wwopy.code_aperiodicity(aperiodicity, fs))"
+  );
+  m.def(
+      "decode_aperiodicity", &decode_aperiodicity, "coded_aperiodicity"_a,
+      "fs"_a, "fft_size"_a, "n_threads"_a = 1,
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>(), R"(
+      Decodes the coded aperiodicity.
+
+      Parameters
+      ----------
+      coded_aperiodicity : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Coded aperiodicity
+      fs : int
+          Sampling frequency
+      fft_size : int
+          FFT size of the decoded aperiodicity
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
+
+      Returns
+      -------
+      np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Decoded aperiodicity.
+
+      Examples
+      --------
+      >>> coded_aperiodicity = wwopy.d4c(x, fs, temporal_positions, f0, fft_size, coded=True)
+      >>> aperiodicity = wwopy.decode_aperiodicity(coded_aperiodicity, fs, fft_size))"
+  );
+}
@@ -7,32 +7,47 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
+#include <world/codec.h>
 #include <world/d4c.h>
 
 #include <cstddef>
 #include <memory>
 #include <optional>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "parallel.hpp"
 #include "util.hpp"
+#include "wwopy_core.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
 namespace {
 
+template <size_t N>
 auto d4c(
-    const util::inputNDarray<1>& x,
+    const util::inputNDarray<N>& x,
     const int fs,
     const util::inputNDarray<1>& temporal_positions,
-    const util::inputNDarray<1>& f0,
+    const util::inputNDarray<N>& f0,
     const int fft_size,
-    const std::optional<double> threshold
+    const std::optional<double> threshold,
+    const bool coded,
+    const std::optional<int> n_threads,
+    const std::string& framework
 ) {
-  util::validate_x_lenth(x.size());
-  util::validate_fs(fs);
-  if (temporal_positions.size() != f0.size()) {
+  const size_t channels = util::channel_count(x);
+  const size_t x_length = x.shape(N - 1);
+  wwopy::validate_x_length(x_length);
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  util::validate_channels(x, f0);
+  const size_t f0_length = f0.shape(N - 1);
+  if (temporal_positions.size() != f0_length) {
     throw std::invalid_argument(
         "The lengths of temporal_positions and f0 do not match."
     );
@@ -40,32 +55,40 @@ auto d4c(
   if (fft_size <= 0) {
     throw std::invalid_argument("fft_size must be non-negative.");
   }
-  D4COption option = {};
-  InitializeD4COption(&option);
-  if (threshold) {
-    option.threshold = *threshold;
-  }
-  const size_t f0_length = f0.size();
+  const D4COption option = wwopy::make_d4c_option({threshold});
+  const size_t threads = util::resolve_n_threads(n_threads);
   const size_t aperiodicity_length = (fft_size / 2) + 1;
-  if (f0_length == 0) {
+  const size_t output_length =
+      coded ? static_cast<size_t>(GetNumberOfAperiodicities(fs))
+            : aperiodicity_length;
+  if (f0_length == 0 || channels == 0) {
     const nb::gil_scoped_acquire gil;
-    return util::outputNDarray<2>(
-        nullptr, {0, aperiodicity_length}, nb::handle()
+    return util::export_batch<N>(
+        nullptr, channels, output_framework, 0, output_length
     );
   }
-  const auto aperiodicity = std::make_unique<double*[]>(f0_length);
-  auto output_array =
-      std::make_unique<double[]>(f0_length * aperiodicity_length);
-  for (size_t i = 0; i < f0_length; i++) {
-    aperiodicity[i] = &output_array[i * aperiodicity_length];
-  }
-  D4C(x.data(), static_cast<int>(x.size()), fs, temporal_positions.data(),
-      f0.data(), static_cast<int>(f0_length), fft_size, &option,
-      aperiodicity.get());
+  const size_t frames = channels * f0_length;
+  auto output_array = std::make_unique<double[]>(frames * output_length);
+  const auto output =
+      util::make_row_pointers(output_array.get(), frames, output_length);
+  // A strided x is gathered around each block of frames by wwopy_core.
+  // Other strided inputs are gathered once. Contiguous rows are used in
+  // place.
+  std::vector<double> f0_storage;
+  std::vector<double> temporal_positions_buffer;
+  const auto f0_rows = util::InputRows<N>(f0).row_pointers(f0_storage);
+  const double* temporal_positions_data =
+      util::InputRows<1>(temporal_positions)
+          .row(0, temporal_positions_buffer);
+  wwopy::d4c(
+      util::strided_signals(x), fs, temporal_positions_data, f0_rows.get(),
+      f0_length, fft_size, option, coded, threads, output.get()
+  );
   {
     const nb::gil_scoped_acquire gil;
-    return util::make_ndarray<util::outputNDarray<2>>(
-        std::move(output_array), {f0_length, aperiodicity_length}
+    return util::export_batch<N>(
+        std::move(output_array), channels, output_framework, f0_length,
+        output_length
     );
   }
 }
@@ -74,20 +97,32 @@ auto d4c(
 
 void d4c_init(nb::module_& m) {
   m.def(
-      "d4c", &d4c, "x"_a, "fs"_a, "temporal_positions"_a, "f0"_a, "fft_size"_a,
-      "threshold"_a = nb::none(), nb::call_guard<nb::gil_scoped_release>(), R"(
+      "d4c", &d4c<1>, "x"_a, "fs"_a, "temporal_positions"_a, "f0"_a,
+      "fft_size"_a, "threshold"_a = nb::none(), "coded"_a = false,
+      "n_threads"_a = 1, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>(), R"(
       Calculates the aperiodicity.
 
+      Frames are passed to World in blocks of 64, one call per block.
+      World restarts the tiny noise it adds to the waveform on every call,
+      so from frame 64 on the result differs slightly from a single World
+      call over all frames, as wwopy returned before.
+
       Parameters
       ----------
       x : np.ndarray[tuple[int], np.dtype[np.double]]
           Input signal
+          A (channels, samples) array analyzes every channel in one call.
+          A strided view is read around each block of frames and never
+          copied whole. Its result can differ from that of a contiguous
+          copy in the last bits.
       fs : int
           Sampling frequency
       temporal_positions : np.ndarray[tuple[int], np.dtype[np.double]]
           Time axis
       f0 : np.ndarray[tuple[int], np.dtype[np.double]]
           F0 contour
+          (channels, frames) if x has channels.
       fft_size : int
           FFT size
           Typically this will be the same as DIO or Harvest.
@@ -96,11 +131,28 @@ void d4c_init(nb::module_& m) {
           D4C identifies whether the frame is voiced segment even if it had an F0.
           If the estimated value falls below the threshold,
           the aperiodicity in whole frequency band will set to 1.0.
+      coded : bool, default False
+          If True, the band-aperiodicity is returned
+          as code_aperiodicity() does.
+          The dense aperiodicity is never allocated.
+      n_threads : int or None, default 1
+          Number of threads. Frames of all channels are split between threads.
+          None uses all hardware threads.
+          The result does not depend on n_threads.
+          World shares its random generator between threads, so the
+          World calls run one at a time unless wwopy is built with
+          WWOPY_WORLD_THREAD_SAFE_RANDN.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
 
       Returns
       -------
       np.ndarray[tuple[int, int], np.dtype[np.double]]
           Aperiodicity estimated by D4C.
+          Coded aperiodicity if coded is True.
+          (channels, frames, bins) if x has channels.
 
       Examples
       --------
@@ -108,4 +160,10 @@ void d4c_init(nb::module_& m) {
       >>> spectrogram, fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0)
       >>> aperiodicity = wwopy.d4c(x, fs, temporal_positions, f0, fft_size))"
   );
+  m.def(
+      "d4c", &d4c<2>, "x"_a, "fs"_a, "temporal_positions"_a, "f0"_a,
+      "fft_size"_a, "threshold"_a = nb::none(), "coded"_a = false,
+      "n_threads"_a = 1, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>()
+  );
 }
@@ -7,105 +7,118 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
 #include <world/dio.h>
 
 #include <cstddef>
 #include <initializer_list>
 #include <memory>
 #include <optional>
-#include <stdexcept>
+#include <string>
 #include <utility>
 
+#include "parallel.hpp"
+#include "segment.hpp"
 #include "util.hpp"
+#include "wwopy_core.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
 namespace {
 
+template <size_t N>
 auto dio(
-    const util::inputNDarray<1>& x,
+    const util::inputNDarray<N>& x,
     const int fs,
     const std::optional<double> f0_floor,
     const std::optional<double> f0_ceil,
     const std::optional<double> channels_in_octave,
     const std::optional<double> frame_period,
     const std::optional<int> speed,
-    const std::optional<double> allowed_range
+    const std::optional<double> allowed_range,
+    const std::optional<int> n_threads,
+    const std::string& framework
 ) {
-  const size_t x_length = x.size();
-  util::validate_x_lenth(x_length);
-  util::validate_fs(fs);
-  DioOption option = {};
-  InitializeDioOption(&option);
-  if (f0_floor) {
-    option.f0_floor = *f0_floor;
-  }
-  if (f0_ceil) {
-    option.f0_ceil = *f0_ceil;
-  }
-  if (channels_in_octave) {
-    option.channels_in_octave = *channels_in_octave;
-  }
-  if (frame_period) {
-    if (*frame_period <= 0) {
-      throw std::invalid_argument("frame_period must be non-negative.");
-    }
-    option.frame_period = *frame_period;
-  }
-  if (speed) {
-    const auto speed_max = 12;
-    if (*speed <= 0 || *speed > speed_max) {
-      throw std::invalid_argument("speed must be in the range 1 to 12.");
-    }
-    option.speed = *speed;
-  }
-  if (allowed_range) {
-    if (*allowed_range < 0) {
-      throw std::invalid_argument("allowed_range must be non-negative.");
-    }
-    option.allowed_range = *allowed_range;
-  }
-  if (x_length == 0) {
+  const size_t channels = util::channel_count(x);
+  const size_t x_length = x.shape(N - 1);
+  wwopy::validate_x_length(x_length);
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  const DioOption option = wwopy::make_dio_option(
+      {f0_floor, f0_ceil, channels_in_octave, frame_period, speed,
+       allowed_range}
+  );
+  if (x_length == 0 || channels == 0) {
     const nb::gil_scoped_acquire gil;
     return nb::make_tuple(
-        util::make_empty_ndarray(), util::make_empty_ndarray(),
+        util::export_ndarray<1>(nullptr, {0}, output_framework),
+        util::export_batch<N>(nullptr, channels, output_framework, 0),
         option.frame_period
     );
   }
   const size_t f0_length =
       GetSamplesForDIO(fs, static_cast<int>(x_length), option.frame_period);
   auto temporal_positions = std::make_unique<double[]>(f0_length);
-  auto f0 = std::make_unique<double[]>(f0_length);
-  Dio(x.data(), static_cast<int>(x_length), fs, &option,
-      temporal_positions.get(), f0.get());
+  auto f0 = std::make_unique<double[]>(channels * f0_length);
+  util::estimate_f0_channels(
+      util::InputRows<N>(x), util::resolve_n_threads(n_threads), f0_length,
+      temporal_positions.get(), f0.get(),
+      [&](const double* signal, double* channel_positions,
+          double* channel_f0) -> void {
+        wwopy::dio(
+            signal, x_length, fs, option, channel_positions, channel_f0
+        );
+      }
+  );
   {
     const nb::gil_scoped_acquire gil;
     return nb::make_tuple(
-        util::make_ndarray<util::outputNDarray<1>>(
-            std::move(temporal_positions), {f0_length}
+        util::export_ndarray<1>(
+            std::move(temporal_positions), {f0_length}, output_framework
+        ),
+        util::export_batch<N>(
+            std::move(f0), channels, output_framework, f0_length
         ),
-        util::make_ndarray<util::outputNDarray<1>>(std::move(f0), {f0_length}),
         option.frame_period
     );
   }
 }
 
+// A single signal is one Dio call, so only a batch takes n_threads.
+auto dio_signal(
+    const util::inputNDarray<1>& x,
+    const int fs,
+    const std::optional<double> f0_floor,
+    const std::optional<double> f0_ceil,
+    const std::optional<double> channels_in_octave,
+    const std::optional<double> frame_period,
+    const std::optional<int> speed,
+    const std::optional<double> allowed_range,
+    const std::string& framework
+) {
+  return dio<1>(
+      x, fs, f0_floor, f0_ceil, channels_in_octave, frame_period, speed,
+      allowed_range, 1, framework
+  );
+}
+
 }  // namespace
 
 void dio_init(nb::module_& m) {
   m.def(
-      "dio", &dio, "x"_a, "fs"_a, "f0_floor"_a = nb::none(),
+      "dio", &dio_signal, "x"_a, "fs"_a, "f0_floor"_a = nb::none(),
       "f0_ceil"_a = nb::none(), "channels_in_octave"_a = nb::none(),
       "frame_period"_a = nb::none(), "speed"_a = nb::none(),
-      "allowed_range"_a = nb::none(), nb::call_guard<nb::gil_scoped_release>(),
-      R"(
+      "allowed_range"_a = nb::none(), "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>(), R"(
       Calculates the F0 contour.
       
       Parameters
       ----------
       x : np.ndarray[tuple[int], np.dtype[np.double]]
           Input signal
+          A (channels, samples) array analyzes every channel in one call.
       fs : int
           Sampling frequency
       f0_floor : float, optional
@@ -118,6 +131,15 @@ void dio_init(nb::module_& m) {
           The signal is downsampled to fs / speed Hz.
       allowed_range : float, optional
           Threshold used for fixing the F0 contour.
+      n_threads : int or None, default 1
+          Only accepted when x has channels.
+          Number of threads. None uses all hardware threads.
+          Channels are analyzed in parallel, each by one DIO call,
+          so the result does not depend on n_threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
       
       Returns
       -------
@@ -125,6 +147,7 @@ void dio_init(nb::module_& m) {
           Time axis estimated by DIO.
       f0 : np.ndarray[tuple[int], np.dtype[np.double]]
           F0 contour estimated by DIO.
+          (channels, frames) if x has channels.
       frame_period : float
           Automatically determined frame_period.
 
@@ -132,4 +155,11 @@ void dio_init(nb::module_& m) {
       --------
       >>> temporal_positions, f0, frame_period = wwopy.dio(x, fs))"
   );
+  m.def(
+      "dio", &dio<2>, "x"_a, "fs"_a, "f0_floor"_a = nb::none(),
+      "f0_ceil"_a = nb::none(), "channels_in_octave"_a = nb::none(),
+      "frame_period"_a = nb::none(), "speed"_a = nb::none(),
+      "allowed_range"_a = nb::none(), "n_threads"_a = 1,
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>()
+  );
 }
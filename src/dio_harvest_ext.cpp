@@ -0,0 +1,276 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "wwopy_init.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
+#include <world/dio.h>
+#include <world/harvest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "segment.hpp"
+#include "util.hpp"
+#include "wwopy_core.hpp"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace {
+
+// Unvoiced gaps up to this length between voiced frames are treated as
+// dropouts of Dio.
+constexpr double kMaxUnvoicedGap = 0.05;
+// Context given to each side of a region replaced by Harvest. Harvest
+// smooths the contour over each voiced section, so frames near the edges
+// of a region can still differ from a call on the whole signal.
+constexpr double kHarvestMargin = 0.5;
+
+struct Region {
+  size_t begin;
+  size_t end;
+};
+
+auto octave_distance(const double a, const double b) -> double {
+  return std::fabs(std::log2(a / b));
+}
+
+// Marks the frames where the F0 of Dio and StoneMask is not trusted.
+auto find_uncertain_frames(
+    const double* dio_f0,
+    const double* refined_f0,
+    const size_t f0_length,
+    const double threshold,
+    const size_t max_gap
+) -> std::vector<bool> {
+  std::vector<bool> uncertain(f0_length, false);
+  for (size_t i = 0; i < f0_length; i++) {
+    // StoneMask moving the estimate far away means Dio was not confident.
+    if (dio_f0[i] > 0.0 && refined_f0[i] > 0.0 &&
+        octave_distance(refined_f0[i], dio_f0[i]) > threshold) {
+      uncertain[i] = true;
+    }
+    // Jumps between voiced frames are usually octave errors.
+    if (i > 0 && refined_f0[i - 1] > 0.0 && refined_f0[i] > 0.0 &&
+        octave_distance(refined_f0[i], refined_f0[i - 1]) > threshold) {
+      uncertain[i - 1] = true;
+      uncertain[i] = true;
+    }
+  }
+  size_t i = 0;
+  while (i < f0_length) {
+    if (refined_f0[i] > 0.0) {
+      i++;
+      continue;
+    }
+    const size_t gap_begin = i;
+    while (i < f0_length && refined_f0[i] <= 0.0) {
+      i++;
+    }
+    if (gap_begin > 0 && i < f0_length && i - gap_begin <= max_gap) {
+      std::fill(
+          uncertain.begin() + static_cast<std::ptrdiff_t>(gap_begin),
+          uncertain.begin() + static_cast<std::ptrdiff_t>(i), true
+      );
+    }
+  }
+  return uncertain;
+}
+
+// Groups uncertain frames into padded regions. Regions whose Harvest
+// contexts would overlap are merged so that no frame is analyzed twice.
+auto make_regions(
+    const std::vector<bool>& uncertain,
+    const size_t padding,
+    const size_t margin
+) -> std::vector<Region> {
+  const size_t f0_length = uncertain.size();
+  std::vector<Region> regions;
+  size_t i = 0;
+  while (i < f0_length) {
+    if (!uncertain[i]) {
+      i++;
+      continue;
+    }
+    const size_t first = i;
+    while (i < f0_length && uncertain[i]) {
+      i++;
+    }
+    const size_t begin = first > padding ? first - padding : 0;
+    const size_t end = std::min(i + padding, f0_length);
+    if (!regions.empty() && regions.back().end + (2 * margin) >= begin) {
+      regions.back().end = end;
+    } else {
+      regions.push_back(Region{begin, end});
+    }
+  }
+  return regions;
+}
+
+auto dio_harvest(
+    const util::inputNDarray<1>& x,
+    const int fs,
+    const std::optional<double> f0_floor,
+    const std::optional<double> f0_ceil,
+    const std::optional<double> frame_period,
+    const std::optional<double> threshold,
+    const std::optional<double> padding,
+    const std::optional<int> n_threads,
+    const std::string& framework
+) {
+  const size_t x_length = x.size();
+  wwopy::validate_x_length(x_length);
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  const DioOption dio_option =
+      wwopy::make_dio_option({f0_floor, f0_ceil, {}, frame_period, {}, {}});
+  // Both estimators share the time axis.
+  const HarvestOption harvest_option = wwopy::make_harvest_option(
+      {f0_floor, f0_ceil, dio_option.frame_period}
+  );
+  const double jump_threshold = threshold.value_or(0.25);
+  if (!(jump_threshold > 0.0)) {
+    throw std::invalid_argument("threshold must be greater than 0.");
+  }
+  const double padding_seconds = padding.value_or(0.05);
+  if (!(padding_seconds >= 0.0)) {
+    throw std::invalid_argument("padding must be non-negative.");
+  }
+  if (x_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return nb::make_tuple(
+        util::export_ndarray<1>(nullptr, {0}, output_framework),
+        util::export_ndarray<1>(nullptr, {0}, output_framework),
+        dio_option.frame_period
+    );
+  }
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const double frame_seconds = dio_option.frame_period / 1000.0;
+  const size_t f0_length = GetSamplesForDIO(
+      fs, static_cast<int>(x_length), dio_option.frame_period
+  );
+  auto temporal_positions = std::make_unique<double[]>(f0_length);
+  auto dio_f0 = std::make_unique<double[]>(f0_length);
+  auto f0 = std::make_unique<double[]>(f0_length);
+  std::vector<double> x_buffer;
+  const double* x_data = util::InputRows<1>(x).row(0, x_buffer);
+  wwopy::dio(
+      x_data, x_length, fs, dio_option, temporal_positions.get(), dio_f0.get()
+  );
+  const double* dio_f0_data = dio_f0.get();
+  wwopy::stonemask(
+      &x_data, 1, x_length, fs, temporal_positions.get(), &dio_f0_data,
+      f0_length, threads, f0.get()
+  );
+  const auto margin_frames =
+      static_cast<size_t>(std::ceil(kHarvestMargin / frame_seconds));
+  const auto regions = make_regions(
+      find_uncertain_frames(
+          dio_f0.get(), f0.get(), f0_length, jump_threshold,
+          static_cast<size_t>(std::ceil(kMaxUnvoicedGap / frame_seconds))
+      ),
+      static_cast<size_t>(std::ceil(padding_seconds / frame_seconds)),
+      margin_frames
+  );
+  util::parallel_for(
+      regions.size(), threads,
+      [&](const size_t begin, const size_t end) -> void {
+        for (size_t i = begin; i < end; i++) {
+          util::estimate_f0_segment(
+              x_data, x_length, fs, harvest_option.frame_period, margin_frames,
+              f0_length, regions[i].begin, regions[i].end, f0.get(),
+              [&](const int length) -> int {
+                return GetSamplesForHarvest(
+                    fs, length, harvest_option.frame_period
+                );
+              },
+              [&](const double* segment, const int length,
+                  double* segment_positions, double* segment_f0) -> void {
+                Harvest(
+                    segment, length, fs, &harvest_option, segment_positions,
+                    segment_f0
+                );
+              }
+          );
+        }
+      }
+  );
+  {
+    const nb::gil_scoped_acquire gil;
+    return nb::make_tuple(
+        util::export_ndarray<1>(
+            std::move(temporal_positions), {f0_length}, output_framework
+        ),
+        util::export_ndarray<1>(std::move(f0), {f0_length}, output_framework),
+        dio_option.frame_period
+    );
+  }
+}
+
+}  // namespace
+
+void dio_harvest_init(nb::module_& m) {
+  m.def(
+      "dio_harvest", &dio_harvest, "x"_a, "fs"_a, "f0_floor"_a = nb::none(),
+      "f0_ceil"_a = nb::none(), "frame_period"_a = nb::none(),
+      "threshold"_a = nb::none(), "padding"_a = nb::none(), "n_threads"_a = 1,
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>(), R"(
+      Calculates the F0 contour with DIO and fixes it with Harvest.
+
+      The F0 contour of DIO is refined by StoneMask.
+      Harvest is then run only around the frames that look unreliable:
+      large jumps between voiced frames, large corrections by StoneMask
+      and short unvoiced gaps inside voiced sections.
+      For clean speech this is close to harvest() at a lower cost.
+
+      Parameters
+      ----------
+      x : np.ndarray[tuple[int], np.dtype[np.double]]
+          Input signal
+      fs : int
+          Sampling frequency
+      f0_floor : float, optional
+      f0_ceil : float, optional
+      frame_period : float, optional
+          Frame shift
+      threshold : float, optional
+          Largest trusted change of F0 in octaves. Defaults to 0.25.
+      padding : float, optional
+          Seconds added on both sides of unreliable frames
+          before they are replaced by Harvest. Defaults to 0.05.
+      n_threads : int or None, default 1
+          Number of threads used by StoneMask and Harvest.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
+
+      Returns
+      -------
+      temporal_positions : np.ndarray[tuple[int], np.dtype[np.double]]
+          Time axis.
+      f0 : np.ndarray[tuple[int], np.dtype[np.double]]
+          F0 contour.
+      frame_period : float
+          Automatically determined frame_period.
+
+      Examples
+      --------
+      >>> temporal_positions, f0, frame_period = wwopy.dio_harvest(x, fs))"
+  );
+}
@@ -7,92 +7,122 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
 #include <world/harvest.h>
 
 #include <cstddef>
 #include <initializer_list>
 #include <memory>
 #include <optional>
-#include <stdexcept>
+#include <string>
 #include <utility>
 
+#include "parallel.hpp"
+#include "segment.hpp"
 #include "util.hpp"
+#include "wwopy_core.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
 namespace {
 
+template <size_t N>
 auto harvest(
-    const util::inputNDarray<1>& x,
+    const util::inputNDarray<N>& x,
     const int fs,
     const std::optional<double> f0_floor,
     const std::optional<double> f0_ceil,
-    const std::optional<double> frame_period
+    const std::optional<double> frame_period,
+    const std::optional<int> n_threads,
+    const std::string& framework
 ) {
-  const size_t x_length = x.size();
-  util::validate_x_lenth(x_length);
-  util::validate_fs(fs);
-  HarvestOption option = {};
-  InitializeHarvestOption(&option);
-  if (f0_floor) {
-    option.f0_floor = *f0_floor;
-  }
-  if (f0_ceil) {
-    option.f0_ceil = *f0_ceil;
-  }
-  if (frame_period) {
-    if (*frame_period <= 0) {
-      throw std::invalid_argument("frame_period must be non-negative.");
-    }
-    option.frame_period = *frame_period;
-  }
-  if (x_length == 0) {
+  const size_t channels = util::channel_count(x);
+  const size_t x_length = x.shape(N - 1);
+  wwopy::validate_x_length(x_length);
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  const HarvestOption option =
+      wwopy::make_harvest_option({f0_floor, f0_ceil, frame_period});
+  if (x_length == 0 || channels == 0) {
     const nb::gil_scoped_acquire gil;
     return nb::make_tuple(
-        util::make_empty_ndarray(), util::make_empty_ndarray(),
+        util::export_ndarray<1>(nullptr, {0}, output_framework),
+        util::export_batch<N>(nullptr, channels, output_framework, 0),
         option.frame_period
     );
   }
   const size_t f0_length =
       GetSamplesForHarvest(fs, static_cast<int>(x_length), option.frame_period);
   auto temporal_positions = std::make_unique<double[]>(f0_length);
-  auto f0 = std::make_unique<double[]>(f0_length);
-  Harvest(
-      x.data(), static_cast<int>(x_length), fs, &option,
-      temporal_positions.get(), f0.get()
+  auto f0 = std::make_unique<double[]>(channels * f0_length);
+  // Harvest smooths the contour over whole voiced sections, so a signal is
+  // never split. Only channels are analyzed in parallel.
+  util::estimate_f0_channels(
+      util::InputRows<N>(x), util::resolve_n_threads(n_threads), f0_length,
+      temporal_positions.get(), f0.get(),
+      [&](const double* signal, double* channel_positions,
+          double* channel_f0) -> void {
+        wwopy::harvest(
+            signal, x_length, fs, option, channel_positions, channel_f0
+        );
+      }
   );
   {
     const nb::gil_scoped_acquire gil;
     return nb::make_tuple(
-        util::make_ndarray<util::outputNDarray<1>>(
-            std::move(temporal_positions), {f0_length}
+        util::export_ndarray<1>(
+            std::move(temporal_positions), {f0_length}, output_framework
+        ),
+        util::export_batch<N>(
+            std::move(f0), channels, output_framework, f0_length
         ),
-        util::make_ndarray<util::outputNDarray<1>>(std::move(f0), {f0_length}),
         option.frame_period
     );
   }
 }
 
+// A single signal is one Harvest call, so only a batch takes n_threads.
+auto harvest_signal(
+    const util::inputNDarray<1>& x,
+    const int fs,
+    const std::optional<double> f0_floor,
+    const std::optional<double> f0_ceil,
+    const std::optional<double> frame_period,
+    const std::string& framework
+) {
+  return harvest<1>(x, fs, f0_floor, f0_ceil, frame_period, 1, framework);
+}
+
 }  // namespace
 
 void harvest_init(nb::module_& m) {
   m.def(
-      "harvest", &harvest, "x"_a, "fs"_a, "f0_floor"_a = nb::none(),
+      "harvest", &harvest_signal, "x"_a, "fs"_a, "f0_floor"_a = nb::none(),
       "f0_ceil"_a = nb::none(), "frame_period"_a = nb::none(),
-      nb::call_guard<nb::gil_scoped_release>(), R"(
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>(), R"(
       Calculates the F0 contour.
 
       Parameters
       ----------
       x : np.ndarray[tuple[int], np.dtype[np.double]]
           Input signal
+          A (channels, samples) array analyzes every channel in one call.
       fs : int
           Sampling frequency
       f0_floor : float, optional
       f0_ceil : float, optional
       frame_period : float, optional
           Frame shift
+      n_threads : int or None, default 1
+          Only accepted when x has channels.
+          Number of threads. None uses all hardware threads.
+          Channels are analyzed in parallel, each by one Harvest call,
+          so the result does not depend on n_threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
 
       Returns
       -------
@@ -100,6 +130,7 @@ void harvest_init(nb::module_& m) {
           Time axis estimated by Harvest.
       f0 : np.ndarray[tuple[int], np.dtype[np.double]]
           F0 contour estimated by Harvest.
+          (channels, frames) if x has channels.
       frame_period : float
           Automatically determined frame_period.
 
@@ -107,4 +138,10 @@ void harvest_init(nb::module_& m) {
       --------
       >>> temporal_positions, f0, frame_period = wwopy.harvest(x, fs))"
   );
+  m.def(
+      "harvest", &harvest<2>, "x"_a, "fs"_a, "f0_floor"_a = nb::none(),
+      "f0_ceil"_a = nb::none(), "frame_period"_a = nb::none(),
+      "n_threads"_a = 1, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>()
+  );
 }
@@ -0,0 +1,22 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "parallel.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+auto util::resolve_n_threads(const std::optional<int> n_threads) -> size_t {
+  if (!n_threads) {
+    const unsigned int hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads == 0 ? 1 : hardware_threads;
+  }
+  if (*n_threads <= 0) {
+    throw std::invalid_argument("n_threads must be greater than 0.");
+  }
+  return static_cast<size_t>(*n_threads);
+}
@@ -0,0 +1,111 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef WWOPY_SRC_PARALLEL_HPP_
+#define WWOPY_SRC_PARALLEL_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+auto resolve_n_threads(std::optional<int> n_threads) -> size_t;
+
+// Splits [0, length) into at most n_threads contiguous chunks and calls
+// func(begin, end) for each of them on its own thread.
+// The calling thread processes the first chunk.
+// The first exception thrown by func is rethrown after all threads joined.
+template <typename F>
+void parallel_for(const size_t length, const size_t n_threads, F&& func) {
+  const size_t n_chunks = std::min(length, n_threads);
+  if (n_chunks <= 1) {
+    if (length != 0) {
+      func(size_t{0}, length);
+    }
+    return;
+  }
+  std::vector<std::exception_ptr> errors(n_chunks);
+  const auto run = [&](const size_t i) noexcept -> void {
+    const size_t begin = length * i / n_chunks;
+    const size_t end = length * (i + 1) / n_chunks;
+    try {
+      func(begin, end);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(n_chunks - 1);
+  try {
+    for (size_t i = 1; i < n_chunks; i++) {
+      threads.emplace_back(run, i);
+    }
+  } catch (...) {
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    throw;
+  }
+  run(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// Calls func(row, begin, end) for every row of a matrix with the given
+// number of columns that overlaps the flat index range [begin, end).
+// begin and end passed to func are column indices within the row.
+template <typename F>
+void for_each_row(
+    size_t begin,
+    const size_t end,
+    const size_t columns,
+    F&& func
+) {
+  while (begin < end) {
+    const size_t row = begin / columns;
+    const size_t row_end = std::min(end, (row + 1) * columns);
+    func(row, begin - (row * columns), row_end - (row * columns));
+    begin = row_end;
+  }
+}
+
+constexpr auto block_count(const size_t columns, const size_t block_length)
+    -> size_t {
+  return (columns + block_length - 1) / block_length;
+}
+
+// Calls func(row, begin, end) for the blocks [first_block, last_block) of a
+// matrix whose rows are cut into blocks of block_length columns.
+// Blocks start at multiples of block_length within each row, so they are
+// the same however the block indices are split between threads.
+template <typename F>
+void for_each_block(
+    const size_t first_block,
+    const size_t last_block,
+    const size_t columns,
+    const size_t block_length,
+    F&& func
+) {
+  const size_t blocks_per_row = block_count(columns, block_length);
+  for (size_t i = first_block; i < last_block; i++) {
+    const size_t row = i / blocks_per_row;
+    const size_t begin = (i % blocks_per_row) * block_length;
+    func(row, begin, std::min(columns, begin + block_length));
+  }
+}
+
+}  // namespace util
+
+#endif
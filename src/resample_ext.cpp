@@ -0,0 +1,269 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "wwopy_init.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "util.hpp"
+#include "wwopy_core.hpp"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// Zero crossings of the sinc on each side of the kernel.
+constexpr double kZeroCrossings = 16.0;
+// Cutoff relative to the lower Nyquist frequency.
+constexpr double kRolloff = 0.945;
+// About 90 dB of stopband attenuation.
+constexpr double kKaiserBeta = 8.6;
+// Above this many phases only kMaxPhases + 1 evenly spaced phases are
+// tabulated, and the taps of an output sample are interpolated linearly
+// between the two nearest ones. The error stays far below the stopband.
+constexpr size_t kMaxPhases = 4096;
+// Partial sums of the dot product. Floating-point addition is not
+// associative, so the compiler keeps a single sum in order unless the
+// loop is split by hand.
+constexpr size_t kAccumulators = 4;
+
+auto bessel_i0(const double x) -> double {
+  const double y = x * x / 4.0;
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; term > sum * 1e-17; k++) {
+    term *= y / (static_cast<double>(k) * k);
+    sum += term;
+  }
+  return sum;
+}
+
+// Polyphase resampler with a Kaiser-windowed sinc kernel.
+// Output sample n is located at input position n * down / up.
+class Resampler {
+ public:
+  Resampler(const int fs, const int target_fs) {
+    const int divisor = std::gcd(fs, target_fs);
+    up = static_cast<size_t>(target_fs / divisor);
+    down = static_cast<size_t>(fs / divisor);
+    const double ratio = static_cast<double>(up) / static_cast<double>(down);
+    cutoff = std::min(1.0, ratio) * kRolloff;
+    half = static_cast<size_t>(std::ceil(kZeroCrossings / cutoff));
+    width = 2 * half;
+    phases = std::min(up, kMaxPhases);
+    // The extra phase at a fraction of 1 ends the last interpolation.
+    const size_t rows = up <= kMaxPhases ? phases : phases + 1;
+    table.resize(rows * width);
+    for (size_t i = 0; i < rows; i++) {
+      fill_taps(
+          static_cast<double>(i) / static_cast<double>(phases),
+          &table[i * width]
+      );
+    }
+  }
+
+  auto output_length(const size_t x_length) const -> size_t {
+    return ((x_length * up) + down - 1) / down;
+  }
+
+  void process(
+      const double* x,
+      const size_t x_length,
+      const size_t begin,
+      const size_t end,
+      double* y
+  ) const {
+    std::vector<double> buffer(up > kMaxPhases ? width : 0);
+    for (size_t n = begin; n < end; n++) {
+      const size_t position = n * down;
+      const size_t phase = position % up;
+      const double* taps = nullptr;
+      if (up > kMaxPhases) {
+        interpolate_taps(phase, buffer.data());
+        taps = buffer.data();
+      } else {
+        taps = &table[phase * width];
+      }
+      const auto start =
+          static_cast<std::ptrdiff_t>(position / up) -
+          static_cast<std::ptrdiff_t>(half) + 1;
+      double sum = 0.0;
+      if (start >= 0 && static_cast<size_t>(start) + width <= x_length) {
+        // width is even but not always a multiple of kAccumulators.
+        const double* src = &x[start];
+        double partial[kAccumulators] = {};
+        size_t k = 0;
+        for (; k + kAccumulators <= width; k += kAccumulators) {
+          for (size_t j = 0; j < kAccumulators; j++) {
+            partial[j] += taps[k + j] * src[k + j];
+          }
+        }
+        for (; k < width; k++) {
+          partial[k % kAccumulators] += taps[k] * src[k];
+        }
+        static_assert(kAccumulators == 4);
+        sum = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+      } else {
+        // Samples outside the signal are zero.
+        for (size_t k = 0; k < width; k++) {
+          const std::ptrdiff_t j = start + static_cast<std::ptrdiff_t>(k);
+          if (j >= 0 && static_cast<size_t>(j) < x_length) {
+            sum += taps[k] * x[j];
+          }
+        }
+      }
+      y[n] = sum;
+    }
+  }
+
+ private:
+  size_t up;
+  size_t down;
+  double cutoff;
+  size_t half;
+  size_t width;
+  size_t phases;
+  std::vector<double> table;
+
+  auto kernel(const double t) const -> double {
+    const double ratio = t / static_cast<double>(half);
+    if (std::fabs(ratio) >= 1.0) {
+      return 0.0;
+    }
+    const double window =
+        bessel_i0(kKaiserBeta * std::sqrt(1.0 - (ratio * ratio))) /
+        bessel_i0(kKaiserBeta);
+    const double phase = kPi * cutoff * t;
+    const double sinc = phase == 0.0 ? 1.0 : std::sin(phase) / phase;
+    return cutoff * sinc * window;
+  }
+
+  // Taps of an output sample fraction of an input sample past the grid,
+  // normalized to unity gain at DC.
+  void fill_taps(const double fraction, double* taps) const {
+    double sum = 0.0;
+    for (size_t k = 0; k < width; k++) {
+      taps[k] = kernel(
+          fraction + static_cast<double>(half) - 1.0 - static_cast<double>(k)
+      );
+      sum += taps[k];
+    }
+    for (size_t k = 0; k < width; k++) {
+      taps[k] /= sum;
+    }
+  }
+
+  // Both tabulated phases have unity gain at DC, so their mix has as well.
+  void interpolate_taps(const size_t phase, double* taps) const {
+    const double position = static_cast<double>(phase) *
+                            static_cast<double>(phases) /
+                            static_cast<double>(up);
+    const auto i = std::min(static_cast<size_t>(position), phases - 1);
+    const double weight = position - static_cast<double>(i);
+    const double* lower = &table[i * width];
+    const double* upper = &table[(i + 1) * width];
+    for (size_t k = 0; k < width; k++) {
+      taps[k] = lower[k] + (weight * (upper[k] - lower[k]));
+    }
+  }
+};
+
+auto resample(
+    const util::inputNDarray<1>& x,
+    const int fs,
+    const int target_fs,
+    const std::optional<int> n_threads,
+    const std::string& framework
+) {
+  wwopy::validate_fs(fs);
+  wwopy::validate_fs(target_fs);
+  const auto output_framework = util::parse_framework(framework);
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t x_length = x.size();
+  if (x_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<1>(nullptr, {0}, output_framework);
+  }
+  std::vector<double> x_buffer;
+  const double* x_data = util::InputRows<1>(x).row(0, x_buffer);
+  std::unique_ptr<double[]> y;
+  size_t y_length = x_length;
+  if (fs == target_fs) {
+    y = std::make_unique<double[]>(y_length);
+    std::copy_n(x_data, x_length, y.get());
+  } else {
+    const Resampler resampler(fs, target_fs);
+    y_length = resampler.output_length(x_length);
+    y = std::make_unique<double[]>(y_length);
+    util::parallel_for(
+        y_length, threads, [&](const size_t begin, const size_t end) -> void {
+          resampler.process(x_data, x_length, begin, end, y.get());
+        }
+    );
+  }
+  {
+    const nb::gil_scoped_acquire gil;
+    return util::export_ndarray<1>(std::move(y), {y_length}, output_framework);
+  }
+}
+
+}  // namespace
+
+void resample_init(nb::module_& m) {
+  m.def(
+      "resample", &resample, "x"_a, "fs"_a, "target_fs"_a,
+      "n_threads"_a = 1, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>(), R"(
+      Resamples the signal to another sampling frequency.
+
+      A polyphase Kaiser-windowed sinc filter computes each output sample
+      directly from the input, without an upsampled intermediate signal.
+      The cutoff is 94.5% of the lower Nyquist frequency.
+      The output has ceil(len(x) * target_fs / fs) samples.
+
+      Parameters
+      ----------
+      x : np.ndarray[tuple[int], np.dtype[np.double]]
+          Input signal
+      fs : int
+          Sampling frequency of x
+      target_fs : int
+          Sampling frequency of the result
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
+
+      Returns
+      -------
+      np.ndarray[tuple[int], np.dtype[np.double]]
+          Resampled signal.
+
+      Examples
+      --------
+      >>> y = wwopy.resample(x, 48000, 16000)
+      >>> temporal_positions, f0, frame_period = wwopy.harvest(y, 16000)
+      >>> spectrogram, fft_size = wwopy.cheaptrick(y, 16000, temporal_positions, f0))"
+  );
+}
@@ -0,0 +1,99 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#ifndef WWOPY_SRC_SEGMENT_HPP_
+#define WWOPY_SRC_SEGMENT_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace util {
+
+// Estimates f0[begin, end) from the part of x around those frames.
+// The segment is padded with margin_frames on both sides.
+template <typename GetSamples, typename Estimate>
+void estimate_f0_segment(
+    const double* x,
+    const size_t x_length,
+    const int fs,
+    const double frame_period,
+    const size_t margin_frames,
+    const size_t f0_length,
+    const size_t begin,
+    const size_t end,
+    double* f0,
+    const GetSamples& get_samples,
+    const Estimate& estimate
+) {
+  const double frame_seconds = frame_period / 1000.0;
+  const size_t first = begin > margin_frames ? begin - margin_frames : 0;
+  const size_t last = std::min(end + margin_frames, f0_length);
+  // Rounding down keeps at least last - first frames in the segment.
+  const auto sample_begin = static_cast<size_t>(
+      std::floor(static_cast<double>(first) * frame_seconds * fs)
+  );
+  const size_t sample_end = std::min(
+      x_length,
+      static_cast<size_t>(
+          std::ceil(static_cast<double>(last) * frame_seconds * fs)
+      )
+  );
+  const auto segment_length = static_cast<int>(sample_end - sample_begin);
+  const auto segment_f0_length =
+      static_cast<size_t>(get_samples(segment_length));
+  auto segment_temporal_positions =
+      std::make_unique<double[]>(segment_f0_length);
+  auto segment_f0 = std::make_unique<double[]>(segment_f0_length);
+  estimate(
+      &x[sample_begin], segment_length, segment_temporal_positions.get(),
+      segment_f0.get()
+  );
+  for (size_t i = begin; i < end; i++) {
+    f0[i] = segment_f0[std::min(i - first, segment_f0_length - 1)];
+  }
+}
+
+// Runs an F0 estimator on each row of x, a util::InputRows of signals.
+// Channels are analyzed in parallel, each by one call on the whole signal.
+// A strided channel is gathered only while it is analyzed.
+// estimate(x, temporal_positions, f0) analyzes one channel.
+template <typename Rows, typename Estimate>
+void estimate_f0_channels(
+    const Rows& x,
+    const size_t n_threads,
+    const size_t f0_length,
+    double* temporal_positions,
+    double* f0,
+    const Estimate& estimate
+) {
+  const size_t channels = x.rows();
+  if (channels == 1) {
+    std::vector<double> buffer;
+    estimate(x.row(0, buffer), temporal_positions, f0);
+    return;
+  }
+  parallel_for(
+      channels, n_threads, [&](const size_t begin, const size_t end) -> void {
+        // All channels share the time axis.
+        auto positions = std::make_unique<double[]>(f0_length);
+        std::vector<double> buffer;
+        for (size_t i = begin; i < end; i++) {
+          estimate(x.row(i, buffer), positions.get(), &f0[i * f0_length]);
+        }
+        if (begin == 0) {
+          std::copy_n(positions.get(), f0_length, temporal_positions);
+        }
+      }
+  );
+}
+
+}  // namespace util
+
+#endif
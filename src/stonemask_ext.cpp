@@ -6,48 +6,71 @@ SPDX-License-Identifier: BSD-2-Clause
 #include "wwopy_init.hpp"
 
 #include <nanobind/nanobind.h>
-#include <world/stonemask.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
 
 #include <cstddef>
 #include <initializer_list>
 #include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "parallel.hpp"
 #include "util.hpp"
+#include "wwopy_core.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
 namespace {
 
+template <size_t N>
 auto stonemask(
-    const util::inputNDarray<1>& x,
+    const util::inputNDarray<N>& x,
     const int fs,
     const util::inputNDarray<1>& temporal_positions,
-    const util::inputNDarray<1>& f0
+    const util::inputNDarray<N>& f0,
+    const std::optional<int> n_threads,
+    const std::string& framework
 ) {
-  util::validate_x_lenth(x.size());
-  util::validate_fs(fs);
-  if (temporal_positions.size() != f0.size()) {
+  const size_t channels = util::channel_count(x);
+  const size_t x_length = x.shape(N - 1);
+  wwopy::validate_x_length(x_length);
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
+  util::validate_channels(x, f0);
+  const size_t f0_length = f0.shape(N - 1);
+  if (temporal_positions.size() != f0_length) {
     throw std::invalid_argument(
         "The lengths of temporal_positions and f0 do not match."
     );
   }
-  const size_t f0_length = f0.size();
-  if (f0_length == 0) {
+  const size_t threads = util::resolve_n_threads(n_threads);
+  if (f0_length == 0 || channels == 0) {
     const nb::gil_scoped_acquire gil;
-    return util::make_empty_ndarray();
+    return util::export_batch<N>(nullptr, channels, output_framework, 0);
   }
-  auto refined_f0 = std::make_unique<double[]>(f0_length);
-  StoneMask(
-      x.data(), static_cast<int>(x.size()), fs, temporal_positions.data(),
-      f0.data(), static_cast<int>(f0_length), refined_f0.get()
+  auto refined_f0 = std::make_unique<double[]>(channels * f0_length);
+  // A strided x is gathered around each block of frames by wwopy_core.
+  // Other strided inputs are gathered once. Contiguous rows are used in
+  // place.
+  std::vector<double> f0_storage;
+  std::vector<double> temporal_positions_buffer;
+  const auto f0_rows = util::InputRows<N>(f0).row_pointers(f0_storage);
+  const double* temporal_positions_data =
+      util::InputRows<1>(temporal_positions)
+          .row(0, temporal_positions_buffer);
+  wwopy::stonemask(
+      util::strided_signals(x), fs, temporal_positions_data, f0_rows.get(),
+      f0_length, threads, refined_f0.get()
   );
   {
     const nb::gil_scoped_acquire gil;
-    return util::make_ndarray<util::outputNDarray<1>>(
-        std::move(refined_f0), {f0_length}
+    return util::export_batch<N>(
+        std::move(refined_f0), channels, output_framework, f0_length
     );
   }
 }
@@ -56,7 +79,8 @@ auto stonemask(
 
 void stonemask_init(nb::module_& m) {
   m.def(
-      "stonemask", &stonemask, "x"_a, "fs"_a, "temporal_positions"_a, "f0"_a,
+      "stonemask", &stonemask<1>, "x"_a, "fs"_a, "temporal_positions"_a,
+      "f0"_a, "n_threads"_a = 1, "framework"_a = "numpy",
       nb::call_guard<nb::gil_scoped_release>(), R"(
       Refines the estimated F0 by Dio()
 
@@ -64,21 +88,39 @@ void stonemask_init(nb::module_& m) {
       ----------
       x : np.ndarray[tuple[int], np.dtype[np.double]]
           Input signal
+          A (channels, samples) array refines every channel in one call.
+          A strided view is read around each block of frames and never
+          copied whole. Its result can differ from that of a contiguous
+          copy in the last bits.
       fs : int
           Sampling frequency
       temporal_positions : np.ndarray[tuple[int], np.dtype[np.double]]
           Time axis by dio()
       f0 : np.ndarray[tuple[int], np.dtype[np.double]]
           F0 contour by dio()
+          (channels, frames) if x has channels.
+      n_threads : int or None, default 1
+          Number of threads. Frames of all channels are split between threads.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
 
       Returns
       -------
       np.ndarray[tuple[int], np.dtype[np.double]]
           Refined F0.
+          (channels, frames) if x has channels.
 
       Examples
       --------
       >>> temporal_positions, f0, frame_period = wwopy.dio(x, fs)
       >>> refined_f0 = wwopy.stonemask(x, fs, temporal_positions, f0))"
   );
+  m.def(
+      "stonemask", &stonemask<2>, "x"_a, "fs"_a, "temporal_positions"_a,
+      "f0"_a, "n_threads"_a = 1, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>()
+  );
 }
@@ -6,15 +6,19 @@ SPDX-License-Identifier: BSD-2-Clause
 #include "wwopy_init.hpp"
 
 #include <nanobind/nanobind.h>
-#include <world/synthesis.h>
+#include <nanobind/stl/string.h>
+#include <world/codec.h>
 
 #include <cstddef>
 #include <initializer_list>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "util.hpp"
+#include "wwopy_core.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -26,9 +30,12 @@ auto synthesis(
     const util::inputNDarray<2>& spectrogram,
     const util::inputNDarray<2>& aperiodicity,
     const double frame_period,
-    const int fs
+    const int fs,
+    const bool coded,
+    const std::string& framework
 ) {
-  util::validate_fs(fs);
+  wwopy::validate_fs(fs);
+  const auto output_framework = util::parse_framework(framework);
   const size_t f0_length = f0.shape(0);
   if (f0_length != spectrogram.shape(0) || f0_length != aperiodicity.shape(0)) {
     throw std::invalid_argument(
@@ -36,38 +43,54 @@ auto synthesis(
     );
   }
   const size_t spectrogram_length = spectrogram.shape(1);
-  if (spectrogram_length != aperiodicity.shape(1)) {
+  const size_t aperiodicity_length = aperiodicity.shape(1);
+  if (coded && aperiodicity_length !=
+                   static_cast<size_t>(GetNumberOfAperiodicities(fs))) {
+    throw std::invalid_argument(
+        "The length of coded aperiodicity does not match fs."
+    );
+  }
+  if (!coded && spectrogram_length != aperiodicity_length) {
     throw std::invalid_argument(
         "The lengths of spectrogram and aperiodicity do not match."
     );
   }
-  const auto y_length = static_cast<size_t>(
-      ((static_cast<double>(f0_length) - 1) * frame_period / 1000.0 * fs) + 1
-  );
+  const size_t y_length =
+      wwopy::synthesis_length(f0_length, frame_period, fs);
   if (f0_length == 0 || y_length == 0) {
     const nb::gil_scoped_acquire gil;
-    return util::make_empty_ndarray();
+    return util::export_ndarray<1>(nullptr, {0}, output_framework);
   }
-  auto tmp_spectram = std::make_unique<const double*[]>(f0_length);
-  auto tmp_aperiodicity = std::make_unique<const double*[]>(f0_length);
-  {
-    const double* spectrogram_data = spectrogram.data();
-    const double* aperiodicity_data = aperiodicity.data();
-    for (size_t i = 0; i < f0_length; i++) {
-      tmp_spectram[i] = &spectrogram_data[spectrogram_length * i];
-      tmp_aperiodicity[i] = &aperiodicity_data[spectrogram_length * i];
-    }
+  const int fft_size = wwopy::restore_fft_size(spectrogram_length);
+  // Strided inputs are gathered. Contiguous rows are used in place.
+  std::vector<double> f0_buffer;
+  std::vector<double> spectrogram_storage;
+  std::vector<double> aperiodicity_storage;
+  const double* f0_data = util::InputRows<1>(f0).row(0, f0_buffer);
+  const auto tmp_spectram =
+      util::InputRows<2>(spectrogram).row_pointers(spectrogram_storage);
+  auto tmp_aperiodicity =
+      util::InputRows<2>(aperiodicity).row_pointers(aperiodicity_storage);
+  std::unique_ptr<double[]> decoded_aperiodicity;
+  if (coded) {
+    decoded_aperiodicity =
+        std::make_unique<double[]>(f0_length * spectrogram_length);
+    wwopy::decode_aperiodicity(
+        tmp_aperiodicity.get(), f0_length, fs, fft_size, 1,
+        decoded_aperiodicity.get()
+    );
+    tmp_aperiodicity = util::make_row_pointers<const double>(
+        decoded_aperiodicity.get(), f0_length, spectrogram_length
+    );
   }
-  const int fft_size = util::restore_fft_size(spectrogram_length);
   auto y = std::make_unique<double[]>(y_length);
-  Synthesis(
-      f0.data(), static_cast<int>(f0_length), tmp_spectram.get(),
-      tmp_aperiodicity.get(), fft_size, frame_period, fs,
-      static_cast<int>(y_length), y.get()
+  wwopy::synthesis(
+      f0_data, f0_length, tmp_spectram.get(), tmp_aperiodicity.get(),
+      spectrogram_length, frame_period, fs, y.get()
   );
   {
     const nb::gil_scoped_acquire gil;
-    return util::make_ndarray<util::outputNDarray<1>>(std::move(y), {y_length});
+    return util::export_ndarray<1>(std::move(y), {y_length}, output_framework);
   }
 }
 
@@ -76,7 +99,8 @@ auto synthesis(
 void synthesis_init(nb::module_& m) {
   m.def(
       "synthesis", &synthesis, "f0"_a, "spectrogram"_a, "aperiodicity"_a,
-      "frame_period"_a, "fs"_a, nb::call_guard<nb::gil_scoped_release>(), R"(
+      "frame_period"_a, "fs"_a, "coded"_a = false, "framework"_a = "numpy",
+      nb::call_guard<nb::gil_scoped_release>(), R"(
       Synthesize the voice based on f0, spectrogram and aperiodicity.
 
       Parameters
@@ -87,10 +111,18 @@ void synthesis_init(nb::module_& m) {
           Spectrogram
       aperiodicity : np.ndarray[tuple[int, int], np.dtype[np.double]]
           Aperiodicity spectrogram
+          or coded aperiodicity if coded is True.
       frame_period : float
           Temporal period used for the analysis
       fs : int
           Sampling frequency
+      coded : bool, default False
+          If True, aperiodicity is the band-aperiodicity returned by
+          d4c(..., coded=True) or code_aperiodicity().
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
 
       Returns
       -------
@@ -7,26 +7,29 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/optional.h>
-#include <world/synthesisrealtime.h>
 
-#include <algorithm>
 #include <cstddef>
-#include <exception>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "util.hpp"
+#include "wwopy_core.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
 namespace {
 
+// Python binding of wwopy::RealtimeSynthesizer. The methods may be called
+// concurrently, since they release the GIL and free-threaded Python has no
+// GIL at all. The core class serializes them, and its lock is never held
+// while acquiring the GIL.
 class RealtimeSynthesizer {
  private:
-  WorldSynthesizer synthesizer;
+  wwopy::RealtimeSynthesizer synthesizer;
 
  public:
   RealtimeSynthesizer(
@@ -36,7 +39,6 @@ class RealtimeSynthesizer {
       int buffer_size,
       int number_of_pointers
   );
-  ~RealtimeSynthesizer();
   auto append(
       const util::inputNDarray<1>& f0,
       const util::inputNDarray<2>& spectrogram,
@@ -53,28 +55,8 @@ RealtimeSynthesizer::RealtimeSynthesizer(
     const int fft_size,
     const int buffer_size,
     const int number_of_pointers
-) {
-  util::validate_fs(fs);
-  if (frame_period <= 0) {
-    throw std::invalid_argument("frame_period must be greater than 0.");
-  }
-  if (fft_size <= 0) {
-    throw std::invalid_argument("fft_size must be greater than 0.");
-  }
-  if (buffer_size <= 0) {
-    throw std::invalid_argument("buffer_size must be greater than 0.");
-  }
-  if (number_of_pointers <= 0) {
-    throw std::invalid_argument("number_of_pointers must be greater than 0.");
-  }
-  synthesizer = {};
-  InitializeSynthesizer(
-      fs, frame_period, fft_size, buffer_size, number_of_pointers, &synthesizer
-  );
-}
-
-RealtimeSynthesizer::~RealtimeSynthesizer() {
-  DestroySynthesizer(&synthesizer);
+)
+    : synthesizer(fs, frame_period, fft_size, buffer_size, number_of_pointers) {
 }
 
 auto RealtimeSynthesizer::append(
@@ -94,67 +76,30 @@ auto RealtimeSynthesizer::append(
         "The lengths of spectrogram and aperiodicity do not match."
     );
   }
-  if (util::restore_fft_size(sp_length) != synthesizer.fft_size) {
-    throw std::invalid_argument(
-        "The lengths of spectrogram and aperiodicity do not match fft_size."
-    );
-  }
-  if (f0_length == 0) {
-    return true;
-  }
-  auto f0_in = std::make_unique<double[]>(f0_length);
-  auto spectrogram_in = std::make_unique<double*[]>(sp_length);
-  auto aperiodicity_in = std::make_unique<double*[]>(sp_length);
-  const auto cleanup = [&]() noexcept -> void {
-    for (size_t i = 0; i < sp_length; i++) {
-      delete[] spectrogram_in[i];
-      delete[] aperiodicity_in[i];
-    }
-  };
-  try {
-    {
-      std::copy_n(f0.data(), f0_length, f0_in.get());
-      const auto* sp_tmp = spectrogram.data();
-      const auto* ap_tmp = aperiodicity.data();
-      for (size_t i = 0; i < f0_length; i++) {
-        auto* sp = new double[sp_length];
-        auto* ap = new double[sp_length];
-        std::copy_n(&sp_tmp[i * sp_length], sp_length, sp);
-        std::copy_n(&ap_tmp[i * sp_length], sp_length, ap);
-        spectrogram_in[i] = sp;
-        aperiodicity_in[i] = ap;
-      }
-    }
-    const bool result =
-        AddParameters(
-            f0_in.get(), static_cast<int>(f0_length), spectrogram_in.get(),
-            aperiodicity_in.get(), &synthesizer
-        ) != 0;
-    if (result) {
-      f0_in.release();
-      spectrogram_in.release();
-      aperiodicity_in.release();
-    } else {
-      cleanup();
-    }
-    return result;
-  } catch (const std::exception& e) {
-    cleanup();
-    throw e;
-  }
+  // Strided inputs are gathered. Contiguous rows are used in place.
+  std::vector<double> f0_buffer;
+  std::vector<double> spectrogram_storage;
+  std::vector<double> aperiodicity_storage;
+  const double* f0_data = util::InputRows<1>(f0).row(0, f0_buffer);
+  const auto sp_rows =
+      util::InputRows<2>(spectrogram).row_pointers(spectrogram_storage);
+  const auto ap_rows =
+      util::InputRows<2>(aperiodicity).row_pointers(aperiodicity_storage);
+  return synthesizer.append(
+      f0_data, f0_length, sp_rows.get(), ap_rows.get(), sp_length
+  );
 }
 
 auto RealtimeSynthesizer::locked() -> bool {
-  return IsLocked(&synthesizer) != 0;
+  return synthesizer.locked();
 }
 
 auto RealtimeSynthesizer::synthesis() -> std::optional<util::outputNDarray<1>> {
-  if (Synthesis2(&synthesizer) == 0) {
+  const size_t buffer_size = synthesizer.buffer_size();
+  auto y = std::make_unique<double[]>(buffer_size);
+  if (!synthesizer.synthesis(y.get())) {
     return std::nullopt;
   }
-  const auto buffer_size = static_cast<size_t>(synthesizer.buffer_size);
-  auto y = std::make_unique<double[]>(buffer_size);
-  std::copy_n(synthesizer.buffer, buffer_size, y.get());
   {
     const nb::gil_scoped_acquire gil;
     return util::make_ndarray<util::outputNDarray<1>>(
@@ -164,7 +109,7 @@ auto RealtimeSynthesizer::synthesis() -> std::optional<util::outputNDarray<1>> {
 }
 
 void RealtimeSynthesizer::refresh() {
-  RefreshSynthesizer(&synthesizer);
+  synthesizer.refresh();
 }
 
 }  // namespace
@@ -199,6 +144,7 @@ void synthesisrealtime_init(nb::module_& m) {
           nb::call_guard<nb::gil_scoped_release>(), R"(
           Attempts to add speech parameters.
           You can add several frames at the same time.
+          The parameters are copied, which allocates two arrays per frame.
 
           Parameters
           ----------
@@ -215,7 +161,9 @@ void synthesisrealtime_init(nb::module_& m) {
               True if added successfully.
               Retrun True if the parameter is an empty array.)"
       )
-      .def("locked", &RealtimeSynthesizer::locked, R"(
+      .def(
+          "locked", &RealtimeSynthesizer::locked,
+          nb::call_guard<nb::gil_scoped_release>(), R"(
           Checks whether the synthesizer is locked or not.
           "Lock" is defined as the situation that the ring buffer cannot add parameters and cannot synthesize the waveform.
           It will be caused when the duration calculated by the number of added frames is below 1 / F0 + buffer_size / fs.
@@ -223,7 +171,8 @@ void synthesisrealtime_init(nb::module_& m) {
 
           Returns
           -------
-          bool)")
+          bool)"
+      )
       .def(
           "synthesis", &RealtimeSynthesizer::synthesis,
           nb::call_guard<nb::gil_scoped_release>(), R"(
@@ -0,0 +1,265 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "wwopy_init.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace {
+
+// Python objects of a task are only touched while holding the GIL.
+// Moving them in and out of the queue does not change reference counts.
+struct Task {
+  nb::callable func;
+  nb::tuple args;
+  nb::dict kwargs;
+  nb::callable callback;
+};
+
+class TaskPool {
+ private:
+  // Shared with the workers, so that it outlives a worker that is still
+  // running the task that shut the pool down or dropped it.
+  struct State {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Task> tasks;
+    bool stopping = false;
+  };
+
+  std::shared_ptr<State> state = std::make_shared<State>();
+  std::mutex join_mutex;
+  std::vector<std::thread> threads;
+  // Written by the constructor only, so any thread may read it.
+  std::vector<std::thread::id> worker_ids;
+
+  static void worker(const std::shared_ptr<State>& shared);
+  static void run(const Task& task);
+  void stop();
+  auto called_from_worker() const -> bool;
+
+ public:
+  explicit TaskPool(std::optional<int> n_threads);
+  TaskPool(const TaskPool&) = delete;
+  TaskPool(TaskPool&&) = delete;
+  auto operator=(const TaskPool&) -> TaskPool& = delete;
+  auto operator=(TaskPool&&) -> TaskPool& = delete;
+  ~TaskPool();
+  void submit(
+      nb::callable func,
+      nb::tuple args,
+      nb::dict kwargs,
+      nb::callable callback
+  );
+  void shutdown();
+  auto n_threads() const -> size_t;
+};
+
+// Python error for an exception that is not one, such as std::bad_alloc.
+// Must be called from a catch block.
+auto current_exception_object() -> nb::object {
+  const nb::module_ builtins = nb::module_::import_("builtins");
+  try {
+    throw;
+  } catch (const std::bad_alloc&) {
+    return builtins.attr("MemoryError")();
+  } catch (const std::exception& e) {
+    return builtins.attr("RuntimeError")(e.what());
+  } catch (...) {
+    return builtins.attr("RuntimeError")("Unknown C++ exception.");
+  }
+}
+
+TaskPool::TaskPool(const std::optional<int> n_threads) {
+  const size_t count = util::resolve_n_threads(n_threads);
+  threads.reserve(count);
+  worker_ids.reserve(count);
+  try {
+    for (size_t i = 0; i < count; i++) {
+      threads.emplace_back(&TaskPool::worker, state);
+      worker_ids.push_back(threads.back().get_id());
+    }
+  } catch (...) {
+    shutdown();
+    throw;
+  }
+}
+
+TaskPool::~TaskPool() {
+  // Joining waits for workers that need the GIL to finish pending tasks.
+  const nb::gil_scoped_release release;
+  if (!called_from_worker()) {
+    shutdown();
+    return;
+  }
+  // A task of this pool dropped the last reference. A worker cannot join
+  // itself, so the workers are detached and finish the queue on their own.
+  stop();
+  const std::lock_guard<std::mutex> lock(join_mutex);
+  for (auto& thread : threads) {
+    if (thread.joinable()) {
+      thread.detach();
+    }
+  }
+}
+
+void TaskPool::worker(const std::shared_ptr<State>& shared) {
+  while (true) {
+    std::optional<Task> task;
+    {
+      std::unique_lock<std::mutex> lock(shared->mutex);
+      shared->condition.wait(lock, [&]() -> bool {
+        return shared->stopping || !shared->tasks.empty();
+      });
+      if (shared->tasks.empty()) {
+        return;
+      }
+      task.emplace(std::move(shared->tasks.front()));
+      shared->tasks.pop_front();
+    }
+    const nb::gil_scoped_acquire gil;
+    run(*task);
+    task.reset();
+  }
+}
+
+void TaskPool::run(const Task& task) {
+  nb::object result = nb::none();
+  nb::object error = nb::none();
+  try {
+    result = task.func(*task.args, **task.kwargs);
+  } catch (nb::python_error& e) {
+    error = nb::borrow(e.value());
+  } catch (...) {
+    // An exception leaving the worker would terminate the process.
+    error = current_exception_object();
+  }
+  try {
+    task.callback(result, error);
+  } catch (nb::python_error& e) {
+    e.discard_as_unraisable(task.callback);
+  } catch (...) {
+    const nb::object exception = current_exception_object();
+    PyErr_SetObject(exception.type().ptr(), exception.ptr());
+    nb::python_error unraisable;
+    unraisable.discard_as_unraisable(task.callback);
+  }
+}
+
+void TaskPool::submit(
+    nb::callable func,
+    nb::tuple args,
+    nb::dict kwargs,
+    nb::callable callback
+) {
+  {
+    const std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->stopping) {
+      throw std::runtime_error("TaskPool is already shut down.");
+    }
+    state->tasks.push_back(
+        Task{std::move(func), std::move(args), std::move(kwargs),
+             std::move(callback)}
+    );
+  }
+  state->condition.notify_one();
+}
+
+void TaskPool::stop() {
+  {
+    const std::lock_guard<std::mutex> lock(state->mutex);
+    state->stopping = true;
+  }
+  state->condition.notify_all();
+}
+
+auto TaskPool::called_from_worker() const -> bool {
+  return std::find(
+             worker_ids.begin(), worker_ids.end(), std::this_thread::get_id()
+         ) != worker_ids.end();
+}
+
+void TaskPool::shutdown() {
+  stop();
+  // A task that shuts its own pool down, as wwopy.aio.set_n_threads() does,
+  // would wait for its own worker. It only stops the pool.
+  if (called_from_worker()) {
+    return;
+  }
+  const std::lock_guard<std::mutex> lock(join_mutex);
+  for (auto& thread : threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+auto TaskPool::n_threads() const -> size_t {
+  return threads.size();
+}
+
+}  // namespace
+
+void taskpool_init(nb::module_& m) {
+  nb::class_<TaskPool>(m, "TaskPool", R"(
+  TaskPool
+
+  Native worker threads that call Python callables.
+  The workers only hold the GIL while calling into Python,
+  so wwopy functions submitted here run in parallel.
+  This is the backend of wwopy.aio.)")
+      .def(
+          nb::init<std::optional<int>>(), "n_threads"_a = 1, R"(
+          Starts the worker threads.
+
+          Parameters
+          ----------
+          n_threads : int or None, default 1
+              Number of threads. None uses all hardware threads.)"
+      )
+      .def("submit", &TaskPool::submit, "func"_a, "args"_a, "kwargs"_a,
+           "callback"_a, R"(
+          Queues func(*args, **kwargs).
+
+          callback(result, error) is called from a worker thread.
+          error is the raised exception or None.
+          Exceptions raised by callback are reported as unraisable.
+
+          Parameters
+          ----------
+          func : Callable
+          args : tuple
+          kwargs : dict
+          callback : Callable[[Any, BaseException | None], None])")
+      .def(
+          "shutdown", &TaskPool::shutdown,
+          nb::call_guard<nb::gil_scoped_release>(), R"(
+          Waits for the queued tasks and stops the worker threads.
+          Calling submit() afterwards raises RuntimeError.
+          Called from a task of this pool, it does not wait.
+          The workers still finish the queued tasks.)"
+      )
+      .def_prop_ro("n_threads", &TaskPool::n_threads, "Number of threads.");
+}
@@ -0,0 +1,378 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "wwopy_init.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "parallel.hpp"
+#include "util.hpp"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+namespace {
+
+void validate_ratio(const double ratio) {
+  if (!std::isfinite(ratio) || ratio <= 0.0) {
+    throw std::invalid_argument("ratio must be greater than 0.");
+  }
+}
+
+// Linear interpolation table mapping each destination index to a source
+// position. Positions outside of the source are clamped to the last element.
+struct InterpolationTable {
+  std::unique_ptr<size_t[]> lower;
+  std::unique_ptr<size_t[]> upper;
+  std::unique_ptr<double[]> weight;
+
+  InterpolationTable(size_t length, size_t source_length, double ratio);
+};
+
+InterpolationTable::InterpolationTable(
+    const size_t length,
+    const size_t source_length,
+    const double ratio
+)
+    : lower(std::make_unique<size_t[]>(length)),
+      upper(std::make_unique<size_t[]>(length)),
+      weight(std::make_unique<double[]>(length)) {
+  const size_t last = source_length - 1;
+  for (size_t i = 0; i < length; i++) {
+    const double position = std::min(
+        static_cast<double>(i) / ratio, static_cast<double>(last)
+    );
+    const auto index = std::min(static_cast<size_t>(position), last);
+    lower[i] = index;
+    upper[i] = std::min(index + 1, last);
+    weight[i] = position - static_cast<double>(index);
+  }
+}
+
+auto pitch_shift(
+    const util::inputNDarray<1>& f0,
+    const double ratio,
+    const std::optional<util::outputNDarray<1>>& out,
+    const std::optional<int> n_threads
+) -> util::outputNDarray<1> {
+  validate_ratio(ratio);
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t f0_length = f0.size();
+  std::unique_ptr<double[]> result;
+  double* dst = nullptr;
+  if (out) {
+    util::validate_output(*out, {f0_length});
+    dst = out->data();
+  } else if (f0_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return util::make_empty_ndarray();
+  } else {
+    result = std::make_unique<double[]>(f0_length);
+    dst = result.get();
+  }
+  std::vector<double> buffer;
+  const double* src = util::InputRows<1>(f0).row(0, buffer);
+  util::parallel_for(
+      f0_length, threads,
+      [&](const size_t begin, const size_t end) noexcept -> void {
+        for (size_t i = begin; i < end; i++) {
+          dst[i] = src[i] * ratio;
+        }
+      }
+  );
+  {
+    const nb::gil_scoped_acquire gil;
+    if (out) {
+      return *out;
+    }
+    return util::make_ndarray<util::outputNDarray<1>>(
+        std::move(result), {f0_length}
+    );
+  }
+}
+
+auto warp_frequency(
+    const util::inputNDarray<2>& spectrogram,
+    const double ratio,
+    const std::optional<util::outputNDarray<2>>& out,
+    const std::optional<int> n_threads
+) -> util::outputNDarray<2> {
+  validate_ratio(ratio);
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t f0_length = spectrogram.shape(0);
+  const size_t spectrogram_length = spectrogram.shape(1);
+  std::unique_ptr<double[]> result;
+  double* dst = nullptr;
+  if (out) {
+    util::validate_output(*out, {f0_length, spectrogram_length});
+    dst = out->data();
+  } else if (f0_length == 0 || spectrogram_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return util::outputNDarray<2>(
+        nullptr, {f0_length, spectrogram_length}, nb::handle()
+    );
+  } else {
+    result = std::make_unique<double[]>(f0_length * spectrogram_length);
+    dst = result.get();
+  }
+  if (spectrogram_length != 0) {
+    const InterpolationTable table(
+        spectrogram_length, spectrogram_length, ratio
+    );
+    std::vector<double> storage;
+    const auto src = util::InputRows<2>(spectrogram).row_pointers(storage);
+    util::parallel_for(
+        f0_length, threads, [&](const size_t begin, const size_t end) -> void {
+          // Rows are warped through a buffer so that out may alias the input.
+          auto buffer = std::make_unique<double[]>(spectrogram_length);
+          for (size_t i = begin; i < end; i++) {
+            const double* row = src[i];
+            for (size_t j = 0; j < spectrogram_length; j++) {
+              const double a = row[table.lower[j]];
+              const double b = row[table.upper[j]];
+              buffer[j] = a + (table.weight[j] * (b - a));
+            }
+            std::copy_n(
+                buffer.get(), spectrogram_length, &dst[i * spectrogram_length]
+            );
+          }
+        }
+    );
+  }
+  {
+    const nb::gil_scoped_acquire gil;
+    if (out) {
+      return *out;
+    }
+    return util::make_ndarray<util::outputNDarray<2>>(
+        std::move(result), {f0_length, spectrogram_length}
+    );
+  }
+}
+
+auto time_stretch(
+    const util::inputNDarray<1>& f0,
+    const util::inputNDarray<2>& spectrogram,
+    const util::inputNDarray<2>& aperiodicity,
+    const double ratio,
+    const std::optional<int> n_threads,
+    const std::string& framework
+) {
+  validate_ratio(ratio);
+  const auto output_framework = util::parse_framework(framework);
+  const size_t threads = util::resolve_n_threads(n_threads);
+  const size_t f0_length = f0.shape(0);
+  if (f0_length != spectrogram.shape(0) || f0_length != aperiodicity.shape(0)) {
+    throw std::invalid_argument(
+        "The lengths of f0 or spectrogram or aperiodicity do not match."
+    );
+  }
+  const size_t spectrogram_length = spectrogram.shape(1);
+  if (spectrogram_length != aperiodicity.shape(1)) {
+    throw std::invalid_argument(
+        "The lengths of spectrogram and aperiodicity do not match."
+    );
+  }
+  if (f0_length == 0) {
+    const nb::gil_scoped_acquire gil;
+    return nb::make_tuple(
+        util::export_ndarray<1>(nullptr, {0}, output_framework),
+        util::export_ndarray<2>(
+            nullptr, {0, spectrogram_length}, output_framework
+        ),
+        util::export_ndarray<2>(
+            nullptr, {0, spectrogram_length}, output_framework
+        )
+    );
+  }
+  const size_t length =
+      static_cast<size_t>(
+          std::round(static_cast<double>(f0_length - 1) * ratio)
+      ) +
+      1;
+  const InterpolationTable table(length, f0_length, ratio);
+  auto f0_out = std::make_unique<double[]>(length);
+  auto spectrogram_out =
+      std::make_unique<double[]>(length * spectrogram_length);
+  auto aperiodicity_out =
+      std::make_unique<double[]>(length * spectrogram_length);
+  std::vector<double> f0_buffer;
+  std::vector<double> spectrogram_storage;
+  std::vector<double> aperiodicity_storage;
+  const double* f0_in = util::InputRows<1>(f0).row(0, f0_buffer);
+  const auto spectrogram_in =
+      util::InputRows<2>(spectrogram).row_pointers(spectrogram_storage);
+  const auto aperiodicity_in =
+      util::InputRows<2>(aperiodicity).row_pointers(aperiodicity_storage);
+  util::parallel_for(
+      length, threads,
+      [&](const size_t begin, const size_t end) noexcept -> void {
+        for (size_t i = begin; i < end; i++) {
+          const size_t lower = table.lower[i];
+          const size_t upper = table.upper[i];
+          const double weight = table.weight[i];
+          // Interpolating between voiced and unvoiced frames would create
+          // spurious F0 values, so the voicing follows the nearest frame.
+          const double f0_a = f0_in[lower];
+          const double f0_b = f0_in[upper];
+          if (f0_a > 0.0 && f0_b > 0.0) {
+            f0_out[i] = f0_a + (weight * (f0_b - f0_a));
+          } else {
+            f0_out[i] = weight < 0.5 ? f0_a : f0_b;
+          }
+          const double* sp_a = spectrogram_in[lower];
+          const double* sp_b = spectrogram_in[upper];
+          const double* ap_a = aperiodicity_in[lower];
+          const double* ap_b = aperiodicity_in[upper];
+          double* sp = &spectrogram_out[i * spectrogram_length];
+          double* ap = &aperiodicity_out[i * spectrogram_length];
+          for (size_t j = 0; j < spectrogram_length; j++) {
+            sp[j] = sp_a[j] + (weight * (sp_b[j] - sp_a[j]));
+          }
+          for (size_t j = 0; j < spectrogram_length; j++) {
+            ap[j] = ap_a[j] + (weight * (ap_b[j] - ap_a[j]));
+          }
+        }
+      }
+  );
+  {
+    const nb::gil_scoped_acquire gil;
+    return nb::make_tuple(
+        util::export_ndarray<1>(std::move(f0_out), {length}, output_framework),
+        util::export_ndarray<2>(
+            std::move(spectrogram_out), {length, spectrogram_length},
+            output_framework
+        ),
+        util::export_ndarray<2>(
+            std::move(aperiodicity_out), {length, spectrogram_length},
+            output_framework
+        )
+    );
+  }
+}
+
+}  // namespace
+
+void transform_init(nb::module_& m) {
+  m.def(
+      "pitch_shift", &pitch_shift, "f0"_a, "ratio"_a,
+      "out"_a.noconvert() = nb::none(), "n_threads"_a = 1,
+      nb::call_guard<nb::gil_scoped_release>(), R"(
+      Scales the F0 contour.
+
+      Unvoiced frames (F0 of 0) stay unvoiced.
+
+      Parameters
+      ----------
+      f0 : np.ndarray[tuple[int], np.dtype[np.double]]
+          F0 contour
+      ratio : float
+          Pitch scaling factor. 2.0 raises the pitch by one octave.
+      out : np.ndarray[tuple[int], np.dtype[np.double]], optional
+          C-contiguous array the result is written to.
+          It may be f0 itself to scale in place.
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+
+      Returns
+      -------
+      np.ndarray[tuple[int], np.dtype[np.double]]
+          Scaled F0 contour. Shares memory with out if it is given.
+
+      Examples
+      --------
+      >>> temporal_positions, f0, frame_period = wwopy.harvest(x, fs)
+      >>> wwopy.pitch_shift(f0, 1.5, out=f0))"
+  );
+  m.def(
+      "warp_frequency", &warp_frequency, "spectrogram"_a, "ratio"_a,
+      "out"_a.noconvert() = nb::none(), "n_threads"_a = 1,
+      nb::call_guard<nb::gil_scoped_release>(), R"(
+      Warps the spectrogram along the frequency axis.
+
+      Each frame is linearly interpolated so that the value at frequency f
+      moves to f * ratio. Frequencies beyond the Nyquist frequency are
+      filled with the value of the last bin.
+      This can be applied to both spectrogram and aperiodicity.
+
+      Parameters
+      ----------
+      spectrogram : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Spectrogram or aperiodicity
+      ratio : float
+          Warping factor. Values above 1.0 move formants up.
+      out : np.ndarray[tuple[int, int], np.dtype[np.double]], optional
+          C-contiguous array the result is written to.
+          It may be spectrogram itself to warp in place.
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+
+      Returns
+      -------
+      np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Warped spectrogram. Shares memory with out if it is given.
+
+      Examples
+      --------
+      >>> spectrogram, fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0)
+      >>> wwopy.warp_frequency(spectrogram, 1.1, out=spectrogram))"
+  );
+  m.def(
+      "time_stretch", &time_stretch, "f0"_a, "spectrogram"_a,
+      "aperiodicity"_a, "ratio"_a, "n_threads"_a = 1,
+      "framework"_a = "numpy", nb::call_guard<nb::gil_scoped_release>(), R"(
+      Changes the number of frames of the speech parameters.
+
+      Frames are linearly interpolated.
+      F0 is only interpolated between voiced frames.
+
+      Parameters
+      ----------
+      f0 : np.ndarray[tuple[int], np.dtype[np.double]]
+          F0 contour
+      spectrogram : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Spectrogram
+      aperiodicity : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Aperiodicity
+      ratio : float
+          Duration scaling factor. 2.0 doubles the number of frames.
+          To convert the frame period, use old_frame_period / new_frame_period.
+      n_threads : int or None, default 1
+          Number of threads.
+          None uses all hardware threads.
+      framework : str, default "numpy"
+          Type of the returned arrays: "numpy", "torch", "jax" or "dlpack".
+          "dlpack" returns an object implementing the DLPack protocol.
+          The result memory is shared without copying.
+
+      Returns
+      -------
+      f0 : np.ndarray[tuple[int], np.dtype[np.double]]
+          Stretched F0 contour.
+      spectrogram : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Stretched spectrogram.
+      aperiodicity : np.ndarray[tuple[int, int], np.dtype[np.double]]
+          Stretched aperiodicity.
+
+      Examples
+      --------
+      >>> f0, spectrogram, aperiodicity = wwopy.time_stretch(f0, spectrogram, aperiodicity, 1.25)
+      >>> y = wwopy.synthesis(f0, spectrogram, aperiodicity, frame_period, fs))"
+  );
+}
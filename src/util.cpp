@@ -7,10 +7,8 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include <nanobind/ndarray.h>
 
-#include <cstddef>
-#include <limits>
-#include <sstream>
 #include <stdexcept>
+#include <string>
 
 namespace nb = nanobind;
 
@@ -21,25 +19,20 @@ auto util::make_empty_ndarray()
   );
 }
 
-void util::validate_x_lenth(size_t x_lenth) {
-  if (x_lenth > static_cast<size_t>(std::numeric_limits<int>::max())) {
-    std::basic_ostringstream<char> s;
-    s << "length of x must be less than or equal to "
-      << std::numeric_limits<int>::max() << ".";
-    throw std::range_error(s.str());
+auto util::parse_framework(const std::string& name) -> Framework {
+  if (name == "numpy") {
+    return Framework::numpy;
   }
-}
-
-void util::validate_fs(int fs) {
-  if (fs <= 0) {
-    throw std::invalid_argument("samplerate must be non-negative.");
+  if (name == "torch") {
+    return Framework::pytorch;
   }
-}
-
-auto util::restore_fft_size(size_t lenth) -> int {
-  if (lenth < 2) {
-    throw std::invalid_argument("lenth is too small");
+  if (name == "jax") {
+    return Framework::jax;
   }
-  const auto result = (lenth - 1) * 2;
-  return static_cast<int>(result);
-}
+  if (name == "dlpack") {
+    return Framework::dlpack;
+  }
+  throw std::invalid_argument(
+      "framework must be one of 'numpy', 'torch', 'jax' or 'dlpack'."
+  );
+}
\ No newline at end of file
@@ -10,13 +10,22 @@ SPDX-License-Identifier: BSD-2-Clause
 #include <nanobind/ndarray.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wwopy_core.hpp"
 
 namespace util {
 
+// Accepts numpy arrays and any DLPack-capable CPU tensor without copying.
 template <size_t N>
-using inputNDarray = nanobind::ndarray<const double, nanobind::ndim<N>>;
+using inputNDarray = nanobind::
+    ndarray<const double, nanobind::ndim<N>, nanobind::device::cpu>;
 
 template <size_t N>
 using outputNDarray =
@@ -36,13 +45,201 @@ auto make_ndarray(
   return out;
 }
 
+enum class Framework { numpy, pytorch, jax, dlpack };
+
+auto parse_framework(const std::string& name) -> Framework;
+
+template <size_t N, typename... F>
+auto export_ndarray_as(
+    std::unique_ptr<double[]>&& ptr,
+    std::initializer_list<size_t> shape
+) -> nanobind::object {
+  using T = nanobind::ndarray<F..., double, nanobind::ndim<N>>;
+  if (!ptr) {
+    return nanobind::cast(T(nullptr, shape, nanobind::handle()));
+  }
+  return nanobind::cast(make_ndarray<T>(std::move(ptr), shape));
+}
+
+// Wraps ptr as an array of the requested framework without copying.
+// A null ptr is allowed for empty arrays. Requires the GIL.
+template <size_t N>
+auto export_ndarray(
+    std::unique_ptr<double[]>&& ptr,
+    std::initializer_list<size_t> shape,
+    const Framework framework
+) -> nanobind::object {
+  switch (framework) {
+    case Framework::pytorch:
+      return export_ndarray_as<N, nanobind::pytorch>(std::move(ptr), shape);
+    case Framework::jax:
+      return export_ndarray_as<N, nanobind::jax>(std::move(ptr), shape);
+    case Framework::dlpack:
+      // nanobind's own array type. It implements __dlpack__() and
+      // __dlpack_device__(), so any framework can import it.
+      return export_ndarray_as<N>(std::move(ptr), shape);
+    case Framework::numpy:
+      break;
+  }
+  return export_ndarray_as<N, nanobind::numpy>(std::move(ptr), shape);
+}
+
+// Exports the result of a function that takes one signal (N == 1) or a
+// (channels, samples) batch of signals (N == 2). A batch result gets a
+// leading channel axis.
+template <size_t N, typename... Dims>
+auto export_batch(
+    std::unique_ptr<double[]>&& ptr,
+    const size_t channels,
+    const Framework framework,
+    const Dims... dims
+) -> nanobind::object {
+  static_assert(N == 1 || N == 2);
+  if constexpr (N == 1) {
+    return export_ndarray<sizeof...(Dims)>(
+        std::move(ptr), {static_cast<size_t>(dims)...}, framework
+    );
+  } else {
+    return export_ndarray<sizeof...(Dims) + 1>(
+        std::move(ptr), {channels, static_cast<size_t>(dims)...}, framework
+    );
+  }
+}
+
+// Reads an input array through its strides. nanobind hands over views such
+// as x[::2] or stereo[:, 0] without making them contiguous. Rows whose
+// elements are adjacent are used in place, so a slice of a memory-mapped
+// recording is never copied; other rows are gathered only when requested.
+template <size_t N>
+class InputRows {
+  static_assert(N == 1 || N == 2);
+
+ public:
+  explicit InputRows(const inputNDarray<N>& x)
+      : data(x.data()),
+        row_count(N == 1 ? 1 : x.shape(0)),
+        column_count(x.shape(N - 1)),
+        row_stride(N == 1 ? 0 : x.stride(0)),
+        column_stride(x.stride(N - 1)) {}
+
+  auto rows() const -> size_t { return row_count; }
+  auto columns() const -> size_t { return column_count; }
+
+  auto operator()(const size_t row, const size_t column) const -> double {
+    return data
+        [(static_cast<int64_t>(row) * row_stride) +
+         (static_cast<int64_t>(column) * column_stride)];
+  }
+
+  // Returns row i. A strided row is gathered into buffer, which must
+  // outlive the returned pointer.
+  auto row(const size_t i, std::vector<double>& buffer) const
+      -> const double* {
+    if (in_place()) {
+      return &data[static_cast<int64_t>(i) * row_stride];
+    }
+    buffer.resize(column_count);
+    gather(i, buffer.data());
+    return buffer.data();
+  }
+
+  // Returns pointers to every row. Strided rows are gathered into storage.
+  auto row_pointers(std::vector<double>& storage) const
+      -> std::unique_ptr<const double*[]> {
+    auto result = std::make_unique<const double*[]>(row_count);
+    if (!in_place()) {
+      storage.resize(row_count * column_count);
+    }
+    for (size_t i = 0; i < row_count; i++) {
+      if (in_place()) {
+        result[i] = &data[static_cast<int64_t>(i) * row_stride];
+      } else {
+        gather(i, &storage[i * column_count]);
+        result[i] = &storage[i * column_count];
+      }
+    }
+    return result;
+  }
+
+ private:
+  const double* data;
+  size_t row_count;
+  size_t column_count;
+  int64_t row_stride;
+  int64_t column_stride;
+
+  auto in_place() const -> bool {
+    return column_count <= 1 || column_stride == 1;
+  }
+
+  void gather(const size_t i, double* out) const {
+    for (size_t j = 0; j < column_count; j++) {
+      out[j] = (*this)(i, j);
+    }
+  }
+};
+
+template <size_t N>
+auto channel_count(const inputNDarray<N>& x) -> size_t {
+  if constexpr (N == 1) {
+    return 1;
+  } else {
+    return x.shape(0);
+  }
+}
+
+// Describes x to the stages of wwopy_core that read signals through
+// strides, so that a strided x is never gathered whole.
+template <size_t N>
+auto strided_signals(const inputNDarray<N>& x) -> wwopy::StridedSignals {
+  return {
+      x.data(), channel_count(x), x.shape(N - 1), N == 1 ? 0 : x.stride(0),
+      x.stride(N - 1)
+  };
+}
+
+// Checks that a batch of F0 contours belongs to the batch of signals.
+template <size_t N>
+void validate_channels(const inputNDarray<N>& x, const inputNDarray<N>& f0) {
+  if (channel_count(x) != channel_count(f0)) {
+    throw std::invalid_argument(
+        "The numbers of channels of x and f0 do not match."
+    );
+  }
+}
+
+// Checks that an array passed as `out` can be written in place.
+template <typename T>
+void validate_output(const T& out, std::initializer_list<size_t> shape) {
+  size_t i = 0;
+  for (const size_t length : shape) {
+    if (out.shape(i) != length) {
+      throw std::invalid_argument("The shape of out does not match.");
+    }
+    i++;
+  }
+  int64_t stride = 1;
+  for (size_t j = shape.size(); j > 0; j--) {
+    if (out.shape(j - 1) > 1 && out.stride(j - 1) != stride) {
+      throw std::invalid_argument("out must be C-contiguous.");
+    }
+    stride *= static_cast<int64_t>(out.shape(j - 1));
+  }
+}
+
+template <typename T>
+auto make_row_pointers(T* data, size_t rows, size_t columns)
+    -> std::unique_ptr<T*[]> {
+  auto result = std::make_unique<T*[]>(rows);
+  for (size_t i = 0; i < rows; i++) {
+    result[i] = &data[i * columns];
+  }
+  return result;
+}
+
 auto make_empty_ndarray()
     -> nanobind::ndarray<nanobind::numpy, double, nanobind::ndim<1>>;
 
-void validate_x_lenth(size_t x_lenth);
-void validate_fs(int fs);
-auto restore_fft_size(size_t lenth) -> int;
-
 }  // namespace util
 
 #endif
@@ -1,26 +1,50 @@
 # SPDX-FileCopyrightText: (c) 2024, sabonerune
 # SPDX-License-Identifier: BSD-2-Clause
 
+from . import aio, cache, corpus
 from ._version import _version as __version__
+from .corpus import process_corpus
 from .wwopy_ext import (  # type: ignore[reportMissingModuleSource]
     RealtimeSynthesizer,
     cheaptrick,
+    code_aperiodicity,
+    code_spectral_envelope,
     d4c,
+    decode_aperiodicity,
+    decode_spectral_envelope,
     dio,
+    dio_harvest,
     get_fft_size_from_f0_floor,
     harvest,
+    pitch_shift,
+    resample,
     stonemask,
     synthesis,
+    time_stretch,
+    warp_frequency,
 )
 
 __all__ = [
     "RealtimeSynthesizer",
     "__version__",
+    "aio",
+    "cache",
     "cheaptrick",
+    "code_aperiodicity",
+    "code_spectral_envelope",
+    "corpus",
     "d4c",
+    "decode_aperiodicity",
+    "decode_spectral_envelope",
     "dio",
+    "dio_harvest",
     "get_fft_size_from_f0_floor",
     "harvest",
+    "pitch_shift",
+    "process_corpus",
+    "resample",
     "stonemask",
     "synthesis",
+    "time_stretch",
+    "warp_frequency",
 ]
@@ -0,0 +1,187 @@
+# SPDX-FileCopyrightText: (c) 2024, sabonerune
+# SPDX-License-Identifier: BSD-2-Clause
+
+"""Awaitable variants of the wwopy functions.
+
+Calls are queued to native worker threads instead of Python threads.
+The result is delivered to the event loop with call_soon_threadsafe.
+
+Examples
+--------
+>>> temporal_positions, f0, frame_period = await wwopy.aio.harvest(x, fs)
+"""
+
+from __future__ import annotations
+
+import asyncio
+import atexit
+import threading
+from typing import TYPE_CHECKING, Any, Callable
+
+from . import wwopy_ext  # type: ignore[reportMissingModuleSource]
+
+if TYPE_CHECKING:
+    import numpy as np
+
+__all__ = [
+    "analyze",
+    "cheaptrick",
+    "d4c",
+    "dio",
+    "dio_harvest",
+    "harvest",
+    "set_n_threads",
+    "stonemask",
+    "synthesis",
+]
+
+
+class _PoolHolder:
+    def __init__(self) -> None:
+        self._lock = threading.Lock()
+        self._pool: wwopy_ext.TaskPool | None = None
+
+    def get(self) -> wwopy_ext.TaskPool:
+        with self._lock:
+            if self._pool is None:
+                self._pool = wwopy_ext.TaskPool(None)
+            return self._pool
+
+    def replace(self, new_pool: wwopy_ext.TaskPool | None) -> None:
+        with self._lock:
+            pool, self._pool = self._pool, new_pool
+        if pool is not None:
+            pool.shutdown()
+
+
+_holder = _PoolHolder()
+atexit.register(_holder.replace, None)
+
+
+def set_n_threads(n_threads: int | None = None) -> None:
+    """Restarts the worker threads with the given number of threads.
+
+    Queued calls are finished by the previous workers.
+
+    Parameters
+    ----------
+    n_threads : int or None, default None
+        Number of threads. None uses all hardware threads, as the pool
+        that is started on first use does.
+    """
+    _holder.replace(wwopy_ext.TaskPool(n_threads))
+
+
+def _resolve(
+    future: asyncio.Future[Any], result: Any, error: BaseException | None
+) -> None:
+    if future.cancelled():
+        return
+    if error is not None:
+        future.set_exception(error)
+    else:
+        future.set_result(result)
+
+
+def _submit(
+    func: Callable[..., Any], args: tuple[Any, ...], kwargs: dict[str, Any]
+) -> asyncio.Future[Any]:
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+
+    def callback(result: Any, error: BaseException | None) -> None:
+        loop.call_soon_threadsafe(_resolve, future, result, error)
+
+    _holder.get().submit(func, args, kwargs, callback)
+    return future
+
+
+def dio(*args: Any, **kwargs: Any) -> asyncio.Future[Any]:
+    """Awaitable variant of wwopy.dio()."""
+    return _submit(wwopy_ext.dio, args, kwargs)
+
+
+def dio_harvest(*args: Any, **kwargs: Any) -> asyncio.Future[Any]:
+    """Awaitable variant of wwopy.dio_harvest()."""
+    return _submit(wwopy_ext.dio_harvest, args, kwargs)
+
+
+def harvest(*args: Any, **kwargs: Any) -> asyncio.Future[Any]:
+    """Awaitable variant of wwopy.harvest()."""
+    return _submit(wwopy_ext.harvest, args, kwargs)
+
+
+def stonemask(*args: Any, **kwargs: Any) -> asyncio.Future[Any]:
+    """Awaitable variant of wwopy.stonemask()."""
+    return _submit(wwopy_ext.stonemask, args, kwargs)
+
+
+def cheaptrick(*args: Any, **kwargs: Any) -> asyncio.Future[Any]:
+    """Awaitable variant of wwopy.cheaptrick()."""
+    return _submit(wwopy_ext.cheaptrick, args, kwargs)
+
+
+def d4c(*args: Any, **kwargs: Any) -> asyncio.Future[Any]:
+    """Awaitable variant of wwopy.d4c()."""
+    return _submit(wwopy_ext.d4c, args, kwargs)
+
+
+def synthesis(*args: Any, **kwargs: Any) -> asyncio.Future[Any]:
+    """Awaitable variant of wwopy.synthesis()."""
+    return _submit(wwopy_ext.synthesis, args, kwargs)
+
+
+def _analyze(
+    x: np.ndarray[tuple[int], np.dtype[np.double]],
+    fs: int,
+    frame_period: float | None,
+) -> tuple[
+    np.ndarray[tuple[int], np.dtype[np.double]],
+    np.ndarray[tuple[int, int], np.dtype[np.double]],
+    np.ndarray[tuple[int, int], np.dtype[np.double]],
+    float,
+]:
+    temporal_positions, f0, frame_period = wwopy_ext.harvest(
+        x, fs, frame_period=frame_period
+    )
+    spectrogram, fft_size = wwopy_ext.cheaptrick(x, fs, temporal_positions, f0)
+    aperiodicity = wwopy_ext.d4c(x, fs, temporal_positions, f0, fft_size)
+    return f0, spectrogram, aperiodicity, frame_period
+
+
+def analyze(
+    x: np.ndarray[tuple[int], np.dtype[np.double]],
+    fs: int,
+    frame_period: float | None = None,
+) -> asyncio.Future[
+    tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int, int], np.dtype[np.double]],
+        np.ndarray[tuple[int, int], np.dtype[np.double]],
+        float,
+    ]
+]:
+    """Runs harvest(), cheaptrick() and d4c() as one task.
+
+    Parameters
+    ----------
+    x : np.ndarray[tuple[int], np.dtype[np.double]]
+        Input signal
+    fs : int
+        Sampling frequency
+    frame_period : float, optional
+        Frame shift
+
+    Returns
+    -------
+    f0 : np.ndarray[tuple[int], np.dtype[np.double]]
+    spectrogram : np.ndarray[tuple[int, int], np.dtype[np.double]]
+    aperiodicity : np.ndarray[tuple[int, int], np.dtype[np.double]]
+    frame_period : float
+
+    Examples
+    --------
+    >>> f0, spectrogram, aperiodicity, frame_period = await wwopy.aio.analyze(x, fs)
+    >>> y = await wwopy.aio.synthesis(f0, spectrogram, aperiodicity, frame_period, fs)
+    """
+    return _submit(_analyze, (x, fs, frame_period), {})
@@ -0,0 +1,308 @@
+# SPDX-FileCopyrightText: (c) 2024, sabonerune
+# SPDX-License-Identifier: BSD-2-Clause
+
+"""Content-addressed cache of analysis results.
+
+Results are keyed by a hash of the input arrays, fs, every option and
+the version of wwopy, since a release may change the results.
+They are kept in memory up to a byte budget, and optionally stored in
+a directory. Cached arrays are read-only. Arrays loaded from the
+directory are memory-mapped.
+
+Examples
+--------
+>>> cache = wwopy.cache.AnalysisCache(directory="~/.cache/wwopy")
+>>> temporal_positions, f0, frame_period = cache.harvest(x, fs)
+>>> spectrogram, fft_size = cache.cheaptrick(x, fs, temporal_positions, f0)
+>>> aperiodicity = cache.d4c(x, fs, temporal_positions, f0, fft_size)
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+import tempfile
+import threading
+from collections import OrderedDict
+from pathlib import Path
+from typing import Any, Callable
+
+import numpy as np
+
+from . import wwopy_ext  # type: ignore[reportMissingModuleSource]
+from ._version import _version
+
+__all__ = ["AnalysisCache"]
+
+# Bumped when the stored format or the meaning of a key changes.
+_KEY_VERSION = 1
+
+
+def _hash_array(hasher: Any, array: Any) -> None:
+    data = np.ascontiguousarray(array, dtype=np.double)
+    hasher.update(repr(data.shape).encode())
+    hasher.update(memoryview(data).cast("B"))
+
+
+def _nbytes(result: tuple[Any, ...]) -> int:
+    return sum(item.nbytes for item in result if isinstance(item, np.ndarray))
+
+
+def _freeze(result: tuple[Any, ...]) -> tuple[Any, ...]:
+    for item in result:
+        if isinstance(item, np.ndarray):
+            item.flags.writeable = False
+    return result
+
+
+class AnalysisCache:
+    """Caches the results of dio(), harvest(), cheaptrick() and d4c().
+
+    Parameters
+    ----------
+    max_bytes : int, default 256 MiB
+        Byte budget of the in-memory store.
+        The least recently used results are dropped first.
+    directory : str or os.PathLike, optional
+        Directory of the on-disk store. Nothing is written if omitted.
+    """
+
+    def __init__(
+        self,
+        max_bytes: int = 256 * 2**20,
+        directory: str | os.PathLike[str] | None = None,
+    ) -> None:
+        if max_bytes < 0:
+            msg = "max_bytes must be non-negative."
+            raise ValueError(msg)
+        self._max_bytes = max_bytes
+        self._directory = None if directory is None else Path(directory).expanduser()
+        self._lock = threading.Lock()
+        self._entries: OrderedDict[str, tuple[Any, ...]] = OrderedDict()
+        self._nbytes = 0
+        if self._directory is not None:
+            self._directory.mkdir(parents=True, exist_ok=True)
+
+    @property
+    def nbytes(self) -> int:
+        """Bytes held by the in-memory store."""
+        with self._lock:
+            return self._nbytes
+
+    def clear(self) -> None:
+        """Empties the in-memory store. The on-disk store is kept."""
+        with self._lock:
+            self._entries.clear()
+            self._nbytes = 0
+
+    def _key(self, name: str, arrays: tuple[Any, ...], options: dict[str, Any]) -> str:
+        hasher = hashlib.blake2b(digest_size=20)
+        hasher.update(f"{_KEY_VERSION}:{_version}:{name}:".encode())
+        for array in arrays:
+            _hash_array(hasher, array)
+        hasher.update(json.dumps(options, sort_keys=True).encode())
+        return hasher.hexdigest()
+
+    def _get_memory(self, key: str) -> tuple[Any, ...] | None:
+        with self._lock:
+            result = self._entries.get(key)
+            if result is not None:
+                self._entries.move_to_end(key)
+            return result
+
+    def _put_memory(self, key: str, result: tuple[Any, ...]) -> None:
+        nbytes = _nbytes(result)
+        if nbytes > self._max_bytes:
+            return
+        with self._lock:
+            if key in self._entries:
+                return
+            self._entries[key] = result
+            self._nbytes += nbytes
+            while self._nbytes > self._max_bytes:
+                _, evicted = self._entries.popitem(last=False)
+                self._nbytes -= _nbytes(evicted)
+
+    def _load(self, key: str) -> tuple[Any, ...] | None:
+        if self._directory is None:
+            return None
+        meta_path = self._directory / f"{key}.json"
+        try:
+            items = json.loads(meta_path.read_text())
+            return tuple(
+                np.load(self._directory / f"{key}.{i}.npy", mmap_mode="r")
+                if item is None
+                else item
+                for i, item in enumerate(items)
+            )
+        except (OSError, ValueError):
+            return None
+
+    def _store(self, key: str, result: tuple[Any, ...]) -> None:
+        if self._directory is None:
+            return
+        items: list[Any] = []
+        for i, item in enumerate(result):
+            if isinstance(item, np.ndarray):
+                self._write(f"{key}.{i}.npy", lambda f, item=item: np.save(f, item))
+                items.append(None)
+            else:
+                items.append(item)
+        # The metadata is written last so that readers never see
+        # a partially stored result.
+        self._write(f"{key}.json", lambda f: f.write(json.dumps(items).encode()))
+
+    def _write(self, name: str, write: Callable[[Any], Any]) -> None:
+        assert self._directory is not None
+        fd, tmp = tempfile.mkstemp(dir=self._directory, suffix=".tmp")
+        try:
+            with os.fdopen(fd, "wb") as f:
+                write(f)
+            Path(tmp).replace(self._directory / name)
+        except BaseException:
+            Path(tmp).unlink(missing_ok=True)
+            raise
+
+    def _call(
+        self,
+        name: str,
+        arrays: tuple[Any, ...],
+        options: dict[str, Any],
+        compute: Callable[[], tuple[Any, ...]],
+    ) -> tuple[Any, ...]:
+        key = self._key(name, arrays, options)
+        result = self._get_memory(key)
+        if result is not None:
+            return result
+        result = self._load(key)
+        if result is None:
+            result = _freeze(compute())
+            self._store(key, result)
+        self._put_memory(key, result)
+        return result
+
+    def dio(
+        self,
+        x: np.ndarray[tuple[int], np.dtype[np.double]],
+        fs: int,
+        f0_floor: float | None = None,
+        f0_ceil: float | None = None,
+        channels_in_octave: float | None = None,
+        frame_period: float | None = None,
+        speed: int | None = None,
+        allowed_range: float | None = None,
+    ) -> tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ]:
+        """Cached variant of wwopy.dio()."""
+        options = {
+            "fs": fs,
+            "f0_floor": f0_floor,
+            "f0_ceil": f0_ceil,
+            "channels_in_octave": channels_in_octave,
+            "frame_period": frame_period,
+            "speed": speed,
+            "allowed_range": allowed_range,
+        }
+        return self._call(  # type: ignore[return-value]
+            "dio", (x,), options, lambda: wwopy_ext.dio(x, **options)
+        )
+
+    def harvest(
+        self,
+        x: np.ndarray[tuple[int], np.dtype[np.double]],
+        fs: int,
+        f0_floor: float | None = None,
+        f0_ceil: float | None = None,
+        frame_period: float | None = None,
+    ) -> tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ]:
+        """Cached variant of wwopy.harvest()."""
+        options = {
+            "fs": fs,
+            "f0_floor": f0_floor,
+            "f0_ceil": f0_ceil,
+            "frame_period": frame_period,
+        }
+        return self._call(  # type: ignore[return-value]
+            "harvest", (x,), options, lambda: wwopy_ext.harvest(x, **options)
+        )
+
+    def cheaptrick(
+        self,
+        x: np.ndarray[tuple[int], np.dtype[np.double]],
+        fs: int,
+        temporal_positions: np.ndarray[tuple[int], np.dtype[np.double]],
+        f0: np.ndarray[tuple[int], np.dtype[np.double]],
+        q1: float | None = None,
+        f0_floor: float | None = None,
+        fft_size: int | None = None,
+        coded_dim: int | None = None,
+        n_threads: int | None = 1,
+    ) -> tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int]:
+        """Cached variant of wwopy.cheaptrick().
+
+        The result does not depend on n_threads, so it is not part of the key.
+        """
+        options = {
+            "fs": fs,
+            "q1": q1,
+            "f0_floor": f0_floor,
+            "fft_size": fft_size,
+            "coded_dim": coded_dim,
+        }
+        return self._call(  # type: ignore[return-value]
+            "cheaptrick",
+            (x, temporal_positions, f0),
+            options,
+            lambda: wwopy_ext.cheaptrick(
+                x,
+                temporal_positions=temporal_positions,
+                f0=f0,
+                **options,
+                n_threads=n_threads,
+            ),
+        )
+
+    def d4c(
+        self,
+        x: np.ndarray[tuple[int], np.dtype[np.double]],
+        fs: int,
+        temporal_positions: np.ndarray[tuple[int], np.dtype[np.double]],
+        f0: np.ndarray[tuple[int], np.dtype[np.double]],
+        fft_size: int,
+        threshold: float | None = None,
+        coded: bool = False,
+        n_threads: int | None = 1,
+    ) -> np.ndarray[tuple[int, int], np.dtype[np.double]]:
+        """Cached variant of wwopy.d4c().
+
+        The result does not depend on n_threads, so it is not part of the key.
+        """
+        options = {
+            "fs": fs,
+            "fft_size": fft_size,
+            "threshold": threshold,
+            "coded": coded,
+        }
+        (aperiodicity,) = self._call(
+            "d4c",
+            (x, temporal_positions, f0),
+            options,
+            lambda: (
+                wwopy_ext.d4c(
+                    x,
+                    temporal_positions=temporal_positions,
+                    f0=f0,
+                    **options,
+                    n_threads=n_threads,
+                ),
+            ),
+        )
+        return aperiodicity
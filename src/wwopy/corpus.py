@@ -0,0 +1,366 @@
+# SPDX-FileCopyrightText: (c) 2024, sabonerune
+# SPDX-License-Identifier: BSD-2-Clause
+
+"""Batch analysis of audio files.
+
+process_corpus() overlaps three stages connected by bounded queues:
+files are decoded on the calling thread, analyzed on native worker
+threads and written by a writer thread. The workers share one
+interpreter, so no per-process copies are made.
+
+Each result is stored as an .npz file that appears atomically, together
+with the analysis options. Files whose result already exists with the
+same options are skipped, so an interrupted run resumes where it stopped.
+
+Examples
+--------
+>>> wwopy.corpus.process_corpus("train.txt", "features", workers=8)
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import queue
+import sys
+import tempfile
+import threading
+import time
+import wave
+import zipfile
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Callable, Iterable, Tuple, Union
+
+import numpy as np
+
+from . import wwopy_ext  # type: ignore[reportMissingModuleSource]
+
+__all__ = ["CorpusProgress", "process_corpus", "read_wav"]
+
+_PathLike = Union[str, "os.PathLike[str]"]
+_Loader = Callable[[Path], Tuple[np.ndarray, int]]
+
+
+@dataclass
+class CorpusProgress:
+    """Progress of process_corpus().
+
+    Attributes
+    ----------
+    total : int
+        Number of files in the manifest.
+    done : int
+        Files analyzed and written by this run.
+    skipped : int
+        Files whose result already existed with the same options.
+    audio_seconds : float
+        Duration of the audio analyzed by this run.
+    elapsed : float
+        Seconds since the run started.
+    """
+
+    total: int
+    done: int = 0
+    skipped: int = 0
+    audio_seconds: float = 0.0
+    elapsed: float = 0.0
+    _start: float = field(
+        default_factory=time.perf_counter, init=False, repr=False, compare=False
+    )
+
+    @property
+    def files_per_second(self) -> float:
+        """Files analyzed per second."""
+        return self.done / self.elapsed if self.elapsed > 0 else 0.0
+
+    @property
+    def realtime_factor(self) -> float:
+        """Seconds of audio analyzed per second."""
+        return self.audio_seconds / self.elapsed if self.elapsed > 0 else 0.0
+
+    def __str__(self) -> str:
+        return (
+            f"{self.done + self.skipped}/{self.total} files"
+            f" ({self.skipped} skipped),"
+            f" {self.files_per_second:.2f} files/s,"
+            f" {self.realtime_factor:.1f}x realtime"
+        )
+
+
+def read_wav(path: Path) -> tuple[np.ndarray[tuple[int], np.dtype[np.double]], int]:
+    """Reads a PCM WAV file. Channels are averaged.
+
+    Parameters
+    ----------
+    path : pathlib.Path
+
+    Returns
+    -------
+    x : np.ndarray[tuple[int], np.dtype[np.double]]
+        Signal in the range [-1, 1].
+    fs : int
+        Sampling frequency
+    """
+    with wave.open(str(path), "rb") as f:
+        nchannels = f.getnchannels()
+        sampwidth = f.getsampwidth()
+        fs = f.getframerate()
+        buffer = f.readframes(-1)
+    if sampwidth == 1:
+        data = np.frombuffer(buffer, np.uint8).astype(np.double) - 128
+    elif sampwidth == 3:
+        raw = np.frombuffer(buffer, np.uint8).reshape(-1, 3)
+        data = (
+            raw[:, 0].astype(np.int32)
+            | (raw[:, 1].astype(np.int32) << 8)
+            | (raw[:, 2].astype(np.int8).astype(np.int32) << 16)
+        ).astype(np.double)
+    elif sampwidth in (2, 4):
+        data = np.frombuffer(buffer, f"<i{sampwidth}").astype(np.double)
+    else:
+        msg = f"{path}: sample width {sampwidth} is not supported."
+        raise ValueError(msg)
+    data /= 2.0 ** (8 * sampwidth - 1)
+    if nchannels != 1:
+        data = data.reshape(-1, nchannels).mean(axis=1)
+    return data, fs
+
+
+def _read_manifest(manifest: _PathLike | Iterable[_PathLike]) -> list[Path]:
+    if isinstance(manifest, (str, os.PathLike)):
+        path = Path(manifest)
+        lines = path.read_text(encoding="utf-8").splitlines()
+        return [
+            path.parent / line.strip()
+            for line in lines
+            if line.strip() and not line.lstrip().startswith("#")
+        ]
+    return [Path(item) for item in manifest]
+
+
+def _output_path(path: Path, root: Path, out_dir: Path) -> Path:
+    try:
+        relative = path.resolve().relative_to(root)
+    except ValueError:
+        msg = f"{path} is not under root {root}."
+        raise ValueError(msg) from None
+    return out_dir / relative.with_suffix(".npz")
+
+
+def _is_current(out_path: Path, options_key: str) -> bool:
+    """Whether out_path holds a result computed with the same options."""
+    try:
+        with np.load(out_path) as data:
+            return "options" in data.files and str(data["options"]) == options_key
+    except (OSError, ValueError, zipfile.BadZipFile):
+        return False
+
+
+def _analyze(
+    x: np.ndarray[tuple[int], np.dtype[np.double]],
+    fs: int,
+    options: dict[str, Any],
+) -> dict[str, Any]:
+    temporal_positions, f0, frame_period = wwopy_ext.harvest(x, fs, **options)
+    spectrogram, fft_size = wwopy_ext.cheaptrick(x, fs, temporal_positions, f0)
+    aperiodicity = wwopy_ext.d4c(x, fs, temporal_positions, f0, fft_size)
+    return {
+        "temporal_positions": temporal_positions,
+        "f0": f0,
+        "spectrogram": spectrogram,
+        "aperiodicity": aperiodicity,
+        "frame_period": np.double(frame_period),
+        "fs": np.int64(fs),
+    }
+
+
+def _save(out_path: Path, result: dict[str, Any]) -> None:
+    out_path.parent.mkdir(parents=True, exist_ok=True)
+    fd, tmp = tempfile.mkstemp(dir=out_path.parent, suffix=".tmp")
+    try:
+        with os.fdopen(fd, "wb") as f:
+            np.savez(f, **result)
+        Path(tmp).replace(out_path)
+    except BaseException:
+        Path(tmp).unlink(missing_ok=True)
+        raise
+
+
+def _print_progress(progress: CorpusProgress) -> None:
+    sys.stderr.write(f"\r{progress}")
+    sys.stderr.flush()
+
+
+def process_corpus(
+    manifest: _PathLike | Iterable[_PathLike],
+    out_dir: _PathLike,
+    *,
+    root: _PathLike | None = None,
+    workers: int | None = None,
+    queue_depth: int = 4,
+    frame_period: float | None = None,
+    f0_floor: float | None = None,
+    f0_ceil: float | None = None,
+    loader: _Loader = read_wav,
+    progress: bool | Callable[[CorpusProgress], Any] = True,
+) -> CorpusProgress:
+    """Analyzes every file of a corpus with harvest(), cheaptrick() and d4c().
+
+    The result of <root>/<name>.wav is written to <out_dir>/<name>.npz
+    with the arrays temporal_positions, f0, spectrogram and aperiodicity,
+    the scalars frame_period and fs, and options, the JSON encoded
+    frame_period, f0_floor and f0_ceil arguments. An existing result is
+    computed again when its options differ.
+
+    Parameters
+    ----------
+    manifest : str, os.PathLike or iterable of them
+        Text file with one audio path per line, relative to the file,
+        or the paths themselves. Empty lines and lines starting with #
+        are ignored.
+    out_dir : str or os.PathLike
+        Output directory.
+    root : str or os.PathLike, optional
+        Directory that the output layout mirrors. Defaults to the common
+        directory of the input files.
+    workers : int, optional
+        Number of analysis threads. Defaults to the number of hardware
+        threads.
+    queue_depth : int, default 4
+        Decoded files that may wait for analysis, and results that may
+        wait to be written. Bounds memory when a stage is slower.
+    frame_period : float, optional
+    f0_floor : float, optional
+    f0_ceil : float, optional
+        Passed to harvest().
+    loader : Callable[[pathlib.Path], tuple[np.ndarray, int]], default read_wav
+        Decodes a file into a signal and its sampling frequency.
+    progress : bool or Callable[[CorpusProgress], Any], default True
+        True prints progress to stderr. A callable is called from the
+        writer thread after each written file instead.
+
+    Returns
+    -------
+    CorpusProgress
+        Final counts and throughput.
+
+    Raises
+    ------
+    Exception
+        The first error raised while decoding, analyzing, writing or
+        reporting progress.
+        Results written before it are kept, so calling again resumes.
+    """
+    if queue_depth <= 0:
+        msg = "queue_depth must be greater than 0."
+        raise ValueError(msg)
+    paths = _read_manifest(manifest)
+    out_dir = Path(out_dir)
+    if root is None:
+        root = (
+            os.path.commonpath([str(p.resolve().parent) for p in paths])
+            if paths
+            else "."
+        )
+    root = Path(root).resolve()
+    jobs = [(path, _output_path(path, root, out_dir)) for path in paths]
+    options = {"frame_period": frame_period, "f0_floor": f0_floor, "f0_ceil": f0_ceil}
+    options_key = json.dumps(options, sort_keys=True)
+    pending = [
+        (path, out_path)
+        for path, out_path in jobs
+        if not _is_current(out_path, options_key)
+    ]
+    state = CorpusProgress(total=len(jobs), skipped=len(jobs) - len(pending))
+    report: Callable[[CorpusProgress], Any] | None
+    if progress is True:
+        report = _print_progress
+    elif progress is False:
+        report = None
+    else:
+        report = progress
+
+    pool = wwopy_ext.TaskPool(workers)
+    # Decoded files that are queued or being analyzed.
+    slots = threading.Semaphore(queue_depth + pool.n_threads)
+    results: queue.Queue[Any] = queue.Queue(maxsize=queue_depth)
+    stop = threading.Event()
+    errors: list[BaseException] = []
+    done = object()
+
+    def fail(error: BaseException) -> None:
+        errors.append(error)
+        stop.set()
+
+    def analyze(
+        x: np.ndarray[tuple[int], np.dtype[np.double]], fs: int
+    ) -> dict[str, Any] | None:
+        if stop.is_set():
+            return None
+        return {**_analyze(x, fs, options), "options": np.str_(options_key)}
+
+    def writer() -> None:
+        while True:
+            item = results.get()
+            if item is done:
+                return
+            out_path, seconds, result, error = item
+            slots.release()
+            # The queue is drained after a failure so that workers never block.
+            if stop.is_set():
+                continue
+            if error is not None:
+                fail(error)
+                continue
+            try:
+                _save(out_path, result)
+            except BaseException as e:  # noqa: BLE001
+                fail(e)
+                continue
+            state.done += 1
+            state.audio_seconds += seconds
+            state.elapsed = time.perf_counter() - state._start
+            if report is not None:
+                try:
+                    report(state)
+                except BaseException as e:  # noqa: BLE001
+                    fail(e)
+
+    writer_thread = threading.Thread(target=writer, name="wwopy-corpus-writer")
+    writer_thread.start()
+    try:
+        for path, out_path in pending:
+            slots.acquire()
+            if stop.is_set():
+                slots.release()
+                break
+            try:
+                x, fs = loader(path)
+            except BaseException:
+                slots.release()
+                raise
+            seconds = len(x) / fs
+
+            def callback(
+                result: Any,
+                error: BaseException | None,
+                out_path: Path = out_path,
+                seconds: float = seconds,
+            ) -> None:
+                results.put((out_path, seconds, result, error))
+
+            pool.submit(analyze, (x, fs), {}, callback)
+    except BaseException:
+        stop.set()
+        raise
+    finally:
+        pool.shutdown()
+        results.put(done)
+        writer_thread.join()
+        state.elapsed = time.perf_counter() - state._start
+        if progress is True and pending:
+            sys.stderr.write("\n")
+    if errors:
+        raise errors[0]
+    return state
@@ -0,0 +1,873 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+#include "wwopy_core.hpp"
+
+#include <world/cheaptrick.h>
+#include <world/codec.h>
+#include <world/d4c.h>
+#include <world/dio.h>
+#include <world/harvest.h>
+#include <world/stonemask.h>
+#include <world/synthesis.h>
+#include <world/synthesisrealtime.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace {
+
+// CheapTrick, D4C, Synthesis and Synthesis2 draw noise from randn() of
+// World. Unless World keeps its state per thread, calls that use it run one
+// at a time, so that every call still sees the sequence of its own
+// randn_reseed().
+auto lock_randn() -> std::unique_lock<std::mutex> {
+#ifdef WWOPY_WORLD_THREAD_SAFE_RANDN
+  return {};
+#else
+  static std::mutex mutex;
+  return std::unique_lock<std::mutex>(mutex);
+#endif
+}
+
+// Number of frames passed to one CheapTrick or D4C call.
+// Both restart World's random generator on every call, so the frames of a
+// call must not depend on n_threads. The length is part of their results,
+// which tests/test_cheaptrick.py and tests/test_d4c.py pin.
+constexpr size_t kFrameBlockLength = 64;
+
+// Lowest F0 that StoneMask and D4C analyze with a window of its own. Lower
+// F0 is treated as unvoiced or raised first. No window of StoneMask,
+// CheapTrick or D4C reaches further than about 2.5 periods of its F0 from
+// the centre of the frame, so a margin of 3 periods of the lowest F0 holds
+// everything they read.
+constexpr double kLowestF0 = 40.0;
+
+// Channels of a batch. Sample j of channel c is rows[c][j * stride].
+struct Channels {
+  const double* const* rows;
+  size_t length;
+  std::ptrdiff_t stride;
+};
+
+// The samples of a channel that a block of frames reads. A channel whose
+// samples are adjacent is passed whole. A strided one is gathered only
+// within a margin of the frames, and the temporal positions are shifted
+// by the samples left out. World clamps every index to the signal, so a
+// frame outside of the window still reads the sample it would have read.
+class SignalWindow {
+ public:
+  SignalWindow(const Channels& x, const int fs, const double lowest_f0)
+      : signals(x),
+        sample_rate(fs),
+        margin(std::ceil(3.0 * fs / lowest_f0) + 2.0) {}
+
+  void select(
+      const size_t channel,
+      const double* temporal_positions,
+      const size_t frames
+  ) {
+    const double* row = signals.rows[channel];
+    if (signals.stride == 1 || signals.length <= 1) {
+      signal_data = row;
+      signal_length = signals.length;
+      position_data = temporal_positions;
+      return;
+    }
+    double lowest = std::numeric_limits<double>::infinity();
+    double highest = -lowest;
+    for (size_t i = 0; i < frames; i++) {
+      lowest = std::fmin(lowest, temporal_positions[i]);
+      highest = std::fmax(highest, temporal_positions[i]);
+    }
+    size_t first = 0;
+    size_t end = signals.length;
+    if (lowest <= highest) {
+      const auto last = static_cast<double>(signals.length - 1);
+      first = static_cast<size_t>(
+          std::clamp(std::floor(lowest * sample_rate) - margin, 0.0, last)
+      );
+      end = static_cast<size_t>(
+                std::clamp(std::ceil(highest * sample_rate) + margin, 0.0, last)
+            ) +
+            1;
+    }
+    samples.resize(end - first);
+    for (size_t j = first; j < end; j++) {
+      samples[j - first] = row[static_cast<std::ptrdiff_t>(j) * signals.stride];
+    }
+    const double offset = static_cast<double>(first) / sample_rate;
+    positions.resize(frames);
+    for (size_t i = 0; i < frames; i++) {
+      positions[i] = temporal_positions[i] - offset;
+    }
+    signal_data = samples.data();
+    signal_length = samples.size();
+    position_data = positions.data();
+  }
+
+  auto signal() const -> const double* { return signal_data; }
+  auto length() const -> int { return static_cast<int>(signal_length); }
+  auto temporal_positions() const -> const double* { return position_data; }
+
+ private:
+  const Channels& signals;
+  int sample_rate;
+  double margin;
+  const double* signal_data = nullptr;
+  size_t signal_length = 0;
+  const double* position_data = nullptr;
+  std::vector<double> samples;
+  std::vector<double> positions;
+};
+
+auto make_channels(
+    const wwopy::StridedSignals& x,
+    std::vector<const double*>& rows
+) -> Channels {
+  rows.resize(x.channels);
+  for (size_t i = 0; i < x.channels; i++) {
+    rows[i] = &x.data[static_cast<std::ptrdiff_t>(i) * x.channel_stride];
+  }
+  return {rows.data(), x.length, x.sample_stride};
+}
+
+void stonemask_channels(
+    const Channels& x,
+    const size_t channels,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const size_t n_threads,
+    double* refined_f0
+) {
+  // Each frame is refined independently. Strided channels are read in
+  // blocks, so that only the samples of a block are gathered at a time.
+  const size_t block_length =
+      x.stride == 1 ? std::max<size_t>(f0_length, 1) : kFrameBlockLength;
+  util::parallel_for(
+      channels * f0_length, n_threads,
+      [&](const size_t begin, const size_t end) -> void {
+        SignalWindow window(x, fs, kLowestF0);
+        util::for_each_row(
+            begin, end, f0_length,
+            [&](const size_t channel, size_t first, const size_t last)
+                -> void {
+              for (; first < last; first += block_length) {
+                const size_t length = std::min(last - first, block_length);
+                window.select(channel, &temporal_positions[first], length);
+                StoneMask(
+                    window.signal(), window.length(), fs,
+                    window.temporal_positions(), &f0[channel][first],
+                    static_cast<int>(length),
+                    &refined_f0[(channel * f0_length) + first]
+                );
+              }
+            }
+        );
+      }
+  );
+}
+
+void cheaptrick_channels(
+    const Channels& x,
+    const size_t channels,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const CheapTrickOption& option,
+    const std::optional<int> coded_dim,
+    const size_t n_threads,
+    double** spectrogram
+) {
+  const size_t spectrum_length = (option.fft_size / 2) + 1;
+  util::parallel_for(
+      channels * util::block_count(f0_length, kFrameBlockLength), n_threads,
+      [&](const size_t begin, const size_t end) -> void {
+        // Only a block of the full spectrogram exists at any time.
+        wwopy::Matrix block(
+            coded_dim ? std::min(kFrameBlockLength, f0_length) : 0,
+            spectrum_length
+        );
+        SignalWindow window(x, fs, std::min(kLowestF0, option.f0_floor));
+        util::for_each_block(
+            begin, end, f0_length, kFrameBlockLength,
+            [&](const size_t channel, const size_t first, const size_t last)
+                -> void {
+              const auto length = static_cast<int>(last - first);
+              double** result = &spectrogram[(channel * f0_length) + first];
+              window.select(channel, &temporal_positions[first], last - first);
+              {
+                const auto randn_lock = lock_randn();
+                CheapTrick(
+                    window.signal(), window.length(), fs,
+                    window.temporal_positions(), &f0[channel][first], length,
+                    &option, coded_dim ? block.row_pointers() : result
+                );
+              }
+              if (coded_dim) {
+                CodeSpectralEnvelope(
+                    block.row_pointers(), length, fs, option.fft_size,
+                    *coded_dim, result
+                );
+              }
+            }
+        );
+      }
+  );
+}
+
+void d4c_channels(
+    const Channels& x,
+    const size_t channels,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const int fft_size,
+    const D4COption& option,
+    const bool coded,
+    const size_t n_threads,
+    double** aperiodicity
+) {
+  const size_t aperiodicity_length = (fft_size / 2) + 1;
+  util::parallel_for(
+      channels * util::block_count(f0_length, kFrameBlockLength), n_threads,
+      [&](const size_t begin, const size_t end) -> void {
+        // Only a block of the dense aperiodicity exists at any time.
+        wwopy::Matrix block(
+            coded ? std::min(kFrameBlockLength, f0_length) : 0,
+            aperiodicity_length
+        );
+        SignalWindow window(x, fs, kLowestF0);
+        util::for_each_block(
+            begin, end, f0_length, kFrameBlockLength,
+            [&](const size_t channel, const size_t first, const size_t last)
+                -> void {
+              const auto length = static_cast<int>(last - first);
+              double** result = &aperiodicity[(channel * f0_length) + first];
+              window.select(channel, &temporal_positions[first], last - first);
+              {
+                const auto randn_lock = lock_randn();
+                D4C(window.signal(), window.length(), fs,
+                    window.temporal_positions(), &f0[channel][first], length,
+                    fft_size, &option, coded ? block.row_pointers() : result);
+              }
+              if (coded) {
+                CodeAperiodicity(
+                    block.row_pointers(), length, fs, fft_size, result
+                );
+              }
+            }
+        );
+      }
+  );
+}
+
+void validate_frame_period(const double frame_period) {
+  if (frame_period <= 0) {
+    throw std::invalid_argument("frame_period must be non-negative.");
+  }
+}
+
+void validate_f0_floor(const int fs, const double f0_floor) {
+  if (f0_floor <= 0.0) {
+    throw std::invalid_argument("f0_floor must be non-negative.");
+  }
+  if (f0_floor < GetF0FloorForCheapTrick(fs, std::numeric_limits<int>::max())) {
+    throw std::invalid_argument("Determine fft_size is invalid.");
+  }
+}
+
+}  // namespace
+
+void wwopy::validate_fs(const int fs) {
+  if (fs <= 0) {
+    throw std::invalid_argument("samplerate must be non-negative.");
+  }
+}
+
+void wwopy::validate_x_length(const size_t x_length) {
+  if (x_length > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    std::basic_ostringstream<char> s;
+    s << "length of x must be less than or equal to "
+      << std::numeric_limits<int>::max() << ".";
+    throw std::range_error(s.str());
+  }
+}
+
+auto wwopy::restore_fft_size(const size_t length) -> int {
+  if (length < 2) {
+    throw std::invalid_argument("lenth is too small");
+  }
+  const auto result = (length - 1) * 2;
+  return static_cast<int>(result);
+}
+
+auto wwopy::make_dio_option(const DioOptions& options) -> DioOption {
+  DioOption option = {};
+  InitializeDioOption(&option);
+  if (options.f0_floor) {
+    option.f0_floor = *options.f0_floor;
+  }
+  if (options.f0_ceil) {
+    option.f0_ceil = *options.f0_ceil;
+  }
+  if (options.channels_in_octave) {
+    option.channels_in_octave = *options.channels_in_octave;
+  }
+  if (options.frame_period) {
+    validate_frame_period(*options.frame_period);
+    option.frame_period = *options.frame_period;
+  }
+  if (options.speed) {
+    const auto speed_max = 12;
+    if (*options.speed <= 0 || *options.speed > speed_max) {
+      throw std::invalid_argument("speed must be in the range 1 to 12.");
+    }
+    option.speed = *options.speed;
+  }
+  if (options.allowed_range) {
+    if (*options.allowed_range < 0) {
+      throw std::invalid_argument("allowed_range must be non-negative.");
+    }
+    option.allowed_range = *options.allowed_range;
+  }
+  return option;
+}
+
+auto wwopy::make_harvest_option(const HarvestOptions& options)
+    -> HarvestOption {
+  HarvestOption option = {};
+  InitializeHarvestOption(&option);
+  if (options.f0_floor) {
+    option.f0_floor = *options.f0_floor;
+  }
+  if (options.f0_ceil) {
+    option.f0_ceil = *options.f0_ceil;
+  }
+  if (options.frame_period) {
+    validate_frame_period(*options.frame_period);
+    option.frame_period = *options.frame_period;
+  }
+  return option;
+}
+
+auto wwopy::make_cheaptrick_option(
+    const int fs,
+    const CheapTrickOptions& options
+) -> CheapTrickOption {
+  validate_fs(fs);
+  CheapTrickOption option{};
+  InitializeCheapTrickOption(fs, &option);
+  if (options.q1) {
+    option.q1 = *options.q1;
+  }
+  if (options.fft_size) {
+    option.fft_size = *options.fft_size;
+    option.f0_floor = GetF0FloorForCheapTrick(fs, *options.fft_size);
+    if (option.f0_floor <= 0) {
+      throw std::invalid_argument("fft_size is invalid.");
+    }
+  } else if (options.f0_floor) {
+    validate_f0_floor(fs, *options.f0_floor);
+    option.f0_floor = *options.f0_floor;
+    option.fft_size = GetFFTSizeForCheapTrick(fs, &option);
+  }
+  if (option.fft_size <= 0) {
+    throw std::invalid_argument("fft_size must be non-negative.");
+  }
+  return option;
+}
+
+auto wwopy::make_d4c_option(const D4COptions& options) -> D4COption {
+  D4COption option = {};
+  InitializeD4COption(&option);
+  if (options.threshold) {
+    option.threshold = *options.threshold;
+  }
+  return option;
+}
+
+auto wwopy::get_fft_size_from_f0_floor(
+    const int fs,
+    const std::optional<double> f0_floor
+) -> int {
+  validate_fs(fs);
+  CheapTrickOption option{};
+  InitializeCheapTrickOption(fs, &option);
+  if (f0_floor) {
+    validate_f0_floor(fs, *f0_floor);
+    option.f0_floor = *f0_floor;
+  }
+  return GetFFTSizeForCheapTrick(fs, &option);
+}
+
+auto wwopy::world_randn_is_thread_safe() -> bool {
+#ifdef WWOPY_WORLD_THREAD_SAFE_RANDN
+  return true;
+#else
+  return false;
+#endif
+}
+
+wwopy::Matrix::Matrix(const size_t rows, const size_t columns) {
+  resize(rows, columns);
+}
+
+wwopy::Matrix::Matrix(const Matrix& other)
+    : row_count(other.row_count),
+      column_count(other.column_count),
+      values(other.values) {
+  update_pointers();
+}
+
+auto wwopy::Matrix::operator=(const Matrix& other) -> Matrix& {
+  if (this != &other) {
+    row_count = other.row_count;
+    column_count = other.column_count;
+    values = other.values;
+    update_pointers();
+  }
+  return *this;
+}
+
+void wwopy::Matrix::resize(const size_t rows, const size_t columns) {
+  row_count = rows;
+  column_count = columns;
+  values.resize(rows * columns);
+  update_pointers();
+}
+
+void wwopy::Matrix::update_pointers() {
+  pointers.resize(row_count);
+  for (size_t i = 0; i < row_count; i++) {
+    pointers[i] = &values[i * column_count];
+  }
+}
+
+void wwopy::decode_aperiodicity(
+    const double* const* coded_aperiodicity,
+    const size_t f0_length,
+    const int fs,
+    const int fft_size,
+    const size_t n_threads,
+    double* aperiodicity
+) {
+  const size_t aperiodicity_length = (fft_size / 2) + 1;
+  auto output = std::make_unique<double*[]>(f0_length);
+  for (size_t i = 0; i < f0_length; i++) {
+    output[i] = &aperiodicity[i * aperiodicity_length];
+  }
+  util::parallel_for(
+      f0_length, n_threads, [&](const size_t begin, const size_t end) -> void {
+        DecodeAperiodicity(
+            &coded_aperiodicity[begin], static_cast<int>(end - begin), fs,
+            fft_size, &output[begin]
+        );
+      }
+  );
+}
+
+void wwopy::dio(
+    const double* x,
+    const size_t x_length,
+    const int fs,
+    const DioOption& option,
+    double* temporal_positions,
+    double* f0
+) {
+  Dio(x, static_cast<int>(x_length), fs, &option, temporal_positions, f0);
+}
+
+void wwopy::harvest(
+    const double* x,
+    const size_t x_length,
+    const int fs,
+    const HarvestOption& option,
+    double* temporal_positions,
+    double* f0
+) {
+  Harvest(x, static_cast<int>(x_length), fs, &option, temporal_positions, f0);
+}
+
+void wwopy::stonemask(
+    const double* const* x,
+    const size_t channels,
+    const size_t x_length,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const size_t n_threads,
+    double* refined_f0
+) {
+  stonemask_channels(
+      {x, x_length, 1}, channels, fs, temporal_positions, f0, f0_length,
+      n_threads, refined_f0
+  );
+}
+
+void wwopy::stonemask(
+    const StridedSignals& x,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const size_t n_threads,
+    double* refined_f0
+) {
+  std::vector<const double*> rows;
+  stonemask_channels(
+      make_channels(x, rows), x.channels, fs, temporal_positions, f0,
+      f0_length, n_threads, refined_f0
+  );
+}
+
+void wwopy::cheaptrick(
+    const double* const* x,
+    const size_t channels,
+    const size_t x_length,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const CheapTrickOption& option,
+    const std::optional<int> coded_dim,
+    const size_t n_threads,
+    double** spectrogram
+) {
+  cheaptrick_channels(
+      {x, x_length, 1}, channels, fs, temporal_positions, f0, f0_length,
+      option, coded_dim, n_threads, spectrogram
+  );
+}
+
+void wwopy::cheaptrick(
+    const StridedSignals& x,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const CheapTrickOption& option,
+    const std::optional<int> coded_dim,
+    const size_t n_threads,
+    double** spectrogram
+) {
+  std::vector<const double*> rows;
+  cheaptrick_channels(
+      make_channels(x, rows), x.channels, fs, temporal_positions, f0,
+      f0_length, option, coded_dim, n_threads, spectrogram
+  );
+}
+
+void wwopy::d4c(
+    const double* const* x,
+    const size_t channels,
+    const size_t x_length,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const int fft_size,
+    const D4COption& option,
+    const bool coded,
+    const size_t n_threads,
+    double** aperiodicity
+) {
+  d4c_channels(
+      {x, x_length, 1}, channels, fs, temporal_positions, f0, f0_length,
+      fft_size, option, coded, n_threads, aperiodicity
+  );
+}
+
+void wwopy::d4c(
+    const StridedSignals& x,
+    const int fs,
+    const double* temporal_positions,
+    const double* const* f0,
+    const size_t f0_length,
+    const int fft_size,
+    const D4COption& option,
+    const bool coded,
+    const size_t n_threads,
+    double** aperiodicity
+) {
+  std::vector<const double*> rows;
+  d4c_channels(
+      make_channels(x, rows), x.channels, fs, temporal_positions, f0,
+      f0_length, fft_size, option, coded, n_threads, aperiodicity
+  );
+}
+
+wwopy::Analyzer::Analyzer(
+    const int fs,
+    const AnalyzerOptions& options,
+    const size_t threads
+)
+    : settings(make_settings(fs, options)),
+      n_threads(std::max<size_t>(threads, 1)) {}
+
+auto wwopy::Analyzer::analyze(const double* x, const size_t x_length)
+    -> const Analysis& {
+  run(settings, x, x_length, n_threads, raw_f0, result);
+  return result;
+}
+
+auto wwopy::Analyzer::make_settings(
+    const int fs,
+    const AnalyzerOptions& options
+) -> Settings {
+  validate_fs(fs);
+  return Settings{
+      fs,
+      options.f0_method,
+      make_dio_option(options.dio),
+      make_harvest_option(options.harvest),
+      make_cheaptrick_option(fs, options.cheaptrick),
+      make_d4c_option(options.d4c),
+  };
+}
+
+void wwopy::Analyzer::run(
+    const Settings& config,
+    const double* x,
+    const size_t x_length,
+    const size_t threads,
+    std::vector<double>& raw_f0,
+    Analysis& out
+) {
+  validate_x_length(x_length);
+  const int fs = config.fs;
+  const auto length = static_cast<int>(x_length);
+  const bool use_dio = config.f0_method == F0Method::dio;
+  const double frame_period =
+      use_dio ? config.dio.frame_period : config.harvest.frame_period;
+  const int fft_size = config.cheaptrick.fft_size;
+  const size_t spectrum_length = (fft_size / 2) + 1;
+  out.frame_period = frame_period;
+  out.fft_size = fft_size;
+  size_t f0_length = 0;
+  if (x_length != 0) {
+    f0_length = use_dio ? GetSamplesForDIO(fs, length, frame_period)
+                        : GetSamplesForHarvest(fs, length, frame_period);
+  }
+  out.temporal_positions.resize(f0_length);
+  out.f0.resize(f0_length);
+  out.spectrogram.resize(f0_length, spectrum_length);
+  out.aperiodicity.resize(f0_length, spectrum_length);
+  if (f0_length == 0) {
+    return;
+  }
+  const double* temporal_positions = out.temporal_positions.data();
+  const double* f0 = out.f0.data();
+  if (use_dio) {
+    raw_f0.resize(f0_length);
+    const double* raw_f0_data = raw_f0.data();
+    dio(x, x_length, fs, config.dio, out.temporal_positions.data(),
+        raw_f0.data());
+    stonemask(
+        &x, 1, x_length, fs, temporal_positions, &raw_f0_data, f0_length,
+        threads, out.f0.data()
+    );
+  } else {
+    harvest(
+        x, x_length, fs, config.harvest, out.temporal_positions.data(),
+        out.f0.data()
+    );
+  }
+  cheaptrick(
+      &x, 1, x_length, fs, temporal_positions, &f0, f0_length,
+      config.cheaptrick, std::nullopt, threads, out.spectrogram.row_pointers()
+  );
+  d4c(&x, 1, x_length, fs, temporal_positions, &f0, f0_length, fft_size,
+      config.d4c, false, threads, out.aperiodicity.row_pointers());
+}
+
+wwopy::BatchAnalyzer::BatchAnalyzer(
+    const int fs,
+    const AnalyzerOptions& options,
+    const size_t threads
+)
+    : settings(Analyzer::make_settings(fs, options)),
+      n_threads(std::max<size_t>(threads, 1)) {}
+
+auto wwopy::BatchAnalyzer::analyze(
+    const double* const* x,
+    const size_t channels,
+    const size_t x_length
+) -> const std::vector<Analysis>& {
+  results.resize(channels);
+  raw_f0.resize(channels);
+  // Whole channels are the cheapest unit to split.
+  const size_t inner_threads = std::max<size_t>(n_threads / channels, 1);
+  util::parallel_for(
+      channels, n_threads, [&](const size_t begin, const size_t end) -> void {
+        for (size_t i = begin; i < end; i++) {
+          Analyzer::run(
+              settings, x[i], x_length, inner_threads, raw_f0[i], results[i]
+          );
+        }
+      }
+  );
+  return results;
+}
+
+auto wwopy::synthesis_length(
+    const size_t f0_length,
+    const double frame_period,
+    const int fs
+) -> size_t {
+  if (f0_length == 0) {
+    return 0;
+  }
+  return static_cast<size_t>(
+      ((static_cast<double>(f0_length) - 1) * frame_period / 1000.0 * fs) + 1
+  );
+}
+
+void wwopy::synthesis(
+    const double* f0,
+    const size_t f0_length,
+    const double* const* spectrogram,
+    const double* const* aperiodicity,
+    const size_t spectrum_length,
+    const double frame_period,
+    const int fs,
+    double* y
+) {
+  validate_fs(fs);
+  const size_t y_length = synthesis_length(f0_length, frame_period, fs);
+  if (y_length == 0) {
+    return;
+  }
+  const auto randn_lock = lock_randn();
+  Synthesis(
+      f0, static_cast<int>(f0_length), spectrogram, aperiodicity,
+      restore_fft_size(spectrum_length), frame_period, fs,
+      static_cast<int>(y_length), y
+  );
+}
+
+wwopy::RealtimeSynthesizer::RealtimeSynthesizer(
+    const int fs,
+    const double frame_period,
+    const int fft_size,
+    const int buffer_size,
+    const int number_of_pointers
+) {
+  validate_fs(fs);
+  if (frame_period <= 0) {
+    throw std::invalid_argument("frame_period must be greater than 0.");
+  }
+  if (fft_size <= 0) {
+    throw std::invalid_argument("fft_size must be greater than 0.");
+  }
+  if (buffer_size <= 0) {
+    throw std::invalid_argument("buffer_size must be greater than 0.");
+  }
+  if (number_of_pointers <= 0) {
+    throw std::invalid_argument("number_of_pointers must be greater than 0.");
+  }
+  synthesizer = {};
+  InitializeSynthesizer(
+      fs, frame_period, fft_size, buffer_size, number_of_pointers, &synthesizer
+  );
+}
+
+wwopy::RealtimeSynthesizer::~RealtimeSynthesizer() {
+  DestroySynthesizer(&synthesizer);
+}
+
+auto wwopy::RealtimeSynthesizer::append(
+    const double* f0,
+    const size_t f0_length,
+    const double* const* spectrogram,
+    const double* const* aperiodicity,
+    const size_t spectrum_length
+) -> bool {
+  if (restore_fft_size(spectrum_length) != synthesizer.fft_size) {
+    throw std::invalid_argument(
+        "The lengths of spectrogram and aperiodicity do not match fft_size."
+    );
+  }
+  if (f0_length == 0) {
+    return true;
+  }
+  // The synthesizer takes ownership of these arrays once they are added.
+  auto f0_in = std::make_unique<double[]>(f0_length);
+  auto spectrogram_in = std::make_unique<double*[]>(f0_length);
+  auto aperiodicity_in = std::make_unique<double*[]>(f0_length);
+  const auto cleanup = [&]() noexcept -> void {
+    for (size_t i = 0; i < f0_length; i++) {
+      delete[] spectrogram_in[i];
+      delete[] aperiodicity_in[i];
+    }
+  };
+  try {
+    std::copy_n(f0, f0_length, f0_in.get());
+    for (size_t i = 0; i < f0_length; i++) {
+      spectrogram_in[i] = new double[spectrum_length];
+      std::copy_n(spectrogram[i], spectrum_length, spectrogram_in[i]);
+      aperiodicity_in[i] = new double[spectrum_length];
+      std::copy_n(aperiodicity[i], spectrum_length, aperiodicity_in[i]);
+    }
+  } catch (...) {
+    cleanup();
+    throw;
+  }
+  bool result = false;
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    result = AddParameters(
+                 f0_in.get(), static_cast<int>(f0_length),
+                 spectrogram_in.get(), aperiodicity_in.get(), &synthesizer
+             ) != 0;
+  }
+  if (result) {
+    f0_in.release();
+    spectrogram_in.release();
+    aperiodicity_in.release();
+  } else {
+    cleanup();
+  }
+  return result;
+}
+
+auto wwopy::RealtimeSynthesizer::locked() -> bool {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return IsLocked(&synthesizer) != 0;
+}
+
+auto wwopy::RealtimeSynthesizer::synthesis(double* y) -> bool {
+  const std::lock_guard<std::mutex> lock(mutex);
+  const auto randn_lock = lock_randn();
+  if (Synthesis2(&synthesizer) == 0) {
+    return false;
+  }
+  std::copy_n(synthesizer.buffer, synthesizer.buffer_size, y);
+  return true;
+}
+
+void wwopy::RealtimeSynthesizer::refresh() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  RefreshSynthesizer(&synthesizer);
+}
+
+auto wwopy::RealtimeSynthesizer::buffer_size() const -> size_t {
+  return static_cast<size_t>(synthesizer.buffer_size);
+}
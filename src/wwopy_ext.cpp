@@ -5,13 +5,25 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include "wwopy_init.hpp"
 
+#include "wwopy_core.hpp"
+
 // NOLINTNEXTLINE
 NB_MODULE(wwopy_ext, m) {
+#ifdef WWOPY_COUNT_ALLOCATIONS
+  alloccount_init(m);
+#endif
   cheeptrick_init(m);
+  codec_init(m);
   d4c_init(m);
   dio_init(m);
+  dio_harvest_init(m);
   harvest_init(m);
+  resample_init(m);
   stonemask_init(m);
   synthesis_init(m);
   synthesisrealtime_init(m);
+  taskpool_init(m);
+  transform_init(m);
+  // Used by the performance tests in benchmark/.
+  m.def("_world_randn_is_thread_safe", &wwopy::world_randn_is_thread_safe);
 }
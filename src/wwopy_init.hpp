@@ -5,10 +5,16 @@ SPDX-License-Identifier: BSD-2-Clause
 
 #include <nanobind/nanobind.h>
 
+void alloccount_init(nanobind::module_&);
 void cheeptrick_init(nanobind::module_&);
+void codec_init(nanobind::module_&);
 void d4c_init(nanobind::module_&);
 void dio_init(nanobind::module_&);
+void dio_harvest_init(nanobind::module_&);
 void harvest_init(nanobind::module_&);
+void resample_init(nanobind::module_&);
 void stonemask_init(nanobind::module_&);
 void synthesis_init(nanobind::module_&);
 void synthesisrealtime_init(nanobind::module_&);
+void taskpool_init(nanobind::module_&);
+void transform_init(nanobind::module_&);
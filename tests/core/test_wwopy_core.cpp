@@ -0,0 +1,307 @@
+/*
+SPDX-FileCopyrightText: (c) 2024, sabonerune
+SPDX-License-Identifier: BSD-2-Clause
+*/
+
+// Tests of the wwopy_core C++ library. They are built when CMake runs
+// without scikit-build-core and are run by ctest. The bindings are tested
+// with pytest.
+
+#include <world/dio.h>
+#include <world/harvest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include "wwopy_core.hpp"
+
+namespace {
+
+constexpr int kFs = 16000;
+constexpr double kPi = 3.141592653589793;
+
+int failures = 0;
+
+void check(const bool condition, const char* what) {
+  if (!condition) {
+    std::printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+// 2.5 seconds of a gliding harmonic tone with a pause and some noise.
+auto make_signal() -> std::vector<double> {
+  const size_t length = kFs * 5 / 2;
+  std::vector<double> x(length);
+  uint32_t state = 1;
+  double phase = 0.0;
+  for (size_t i = 0; i < length; i++) {
+    const double t = static_cast<double>(i) / kFs;
+    const double f0 = 120.0 + (60.0 * t) + (5.0 * std::sin(2 * kPi * 5 * t));
+    phase += 2 * kPi * f0 / kFs;
+    state = (state * 1664525U) + 1013904223U;
+    const double noise = (static_cast<double>(state) / 4294967296.0) - 0.5;
+    const double voiced = (t > 1.0 && t < 1.3) ? 0.0 : 1.0;
+    x[i] = (0.01 * noise) +
+           (voiced * 0.3 * (std::sin(phase) + (0.5 * std::sin(2 * phase))));
+  }
+  return x;
+}
+
+auto same(const std::vector<double>& a, const std::vector<double>& b)
+    -> bool {
+  return a == b;
+}
+
+auto same(const wwopy::Matrix& a, const wwopy::Matrix& b) -> bool {
+  if (a.rows() != b.rows() || a.columns() != b.columns()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.rows() * a.columns(); i++) {
+    if (a.data()[i] != b.data()[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Strided signals are read through shifted temporal positions, which may
+// change the result in the last bits.
+auto close(const wwopy::Matrix& a, const wwopy::Matrix& b) -> bool {
+  if (a.rows() != b.rows() || a.columns() != b.columns()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.rows() * a.columns(); i++) {
+    const double tolerance = 1e-9 * std::fabs(b.data()[i]);
+    if (!(std::fabs(a.data()[i] - b.data()[i]) <= tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto same(const wwopy::Analysis& a, const wwopy::Analysis& b) -> bool {
+  return same(a.temporal_positions, b.temporal_positions) &&
+         same(a.f0, b.f0) && same(a.spectrogram, b.spectrogram) &&
+         same(a.aperiodicity, b.aperiodicity) &&
+         a.frame_period == b.frame_period && a.fft_size == b.fft_size;
+}
+
+auto options(const wwopy::F0Method method) -> wwopy::AnalyzerOptions {
+  wwopy::AnalyzerOptions result;
+  result.f0_method = method;
+  return result;
+}
+
+// Analyzer must give the results of the stages the bindings call.
+void test_analyzer_matches_stages(const std::vector<double>& x) {
+  const double* signal = x.data();
+  wwopy::Analyzer analyzer(kFs, options(wwopy::F0Method::dio));
+  const auto& result = analyzer.analyze(signal, x.size());
+  const DioOption dio_option = wwopy::make_dio_option({});
+  const size_t f0_length = GetSamplesForDIO(
+      kFs, static_cast<int>(x.size()), dio_option.frame_period
+  );
+  std::vector<double> temporal_positions(f0_length);
+  std::vector<double> raw_f0(f0_length);
+  std::vector<double> f0(f0_length);
+  wwopy::dio(
+      signal, x.size(), kFs, dio_option, temporal_positions.data(),
+      raw_f0.data()
+  );
+  const double* raw_f0_data = raw_f0.data();
+  wwopy::stonemask(
+      &signal, 1, x.size(), kFs, temporal_positions.data(), &raw_f0_data,
+      f0_length, 1, f0.data()
+  );
+  const CheapTrickOption cheaptrick_option =
+      wwopy::make_cheaptrick_option(kFs, {});
+  const size_t spectrum_length = (cheaptrick_option.fft_size / 2) + 1;
+  wwopy::Matrix spectrogram(f0_length, spectrum_length);
+  wwopy::Matrix aperiodicity(f0_length, spectrum_length);
+  const double* f0_data = f0.data();
+  wwopy::cheaptrick(
+      &signal, 1, x.size(), kFs, temporal_positions.data(), &f0_data,
+      f0_length, cheaptrick_option, std::nullopt, 1,
+      spectrogram.row_pointers()
+  );
+  wwopy::d4c(
+      &signal, 1, x.size(), kFs, temporal_positions.data(), &f0_data,
+      f0_length, cheaptrick_option.fft_size, wwopy::make_d4c_option({}),
+      false, 1, aperiodicity.row_pointers()
+  );
+  check(same(result.temporal_positions, temporal_positions), "Analyzer tp");
+  check(same(result.f0, f0), "Analyzer f0");
+  check(same(result.spectrogram, spectrogram), "Analyzer spectrogram");
+  check(same(result.aperiodicity, aperiodicity), "Analyzer aperiodicity");
+}
+
+// n_threads only splits the frames of StoneMask, CheapTrick and D4C, so
+// the result must not depend on it.
+void test_analyzer_n_threads(const std::vector<double>& x) {
+  for (const auto method : {wwopy::F0Method::dio, wwopy::F0Method::harvest}) {
+    const auto expected =
+        wwopy::Analyzer(kFs, options(method)).analyze(x.data(), x.size());
+    const auto result =
+        wwopy::Analyzer(kFs, options(method), 4).analyze(x.data(), x.size());
+    check(same(result, expected), "Analyzer with 4 threads");
+  }
+}
+
+// A second call of the same length must reuse every buffer.
+void test_analyzer_reuses_buffers(const std::vector<double>& x) {
+  wwopy::Analyzer analyzer(kFs, options(wwopy::F0Method::dio), 2);
+  const auto& first = analyzer.analyze(x.data(), x.size());
+  const wwopy::Analysis copy = first;
+  const double* f0 = first.f0.data();
+  const double* spectrogram = first.spectrogram.data();
+  const auto& second = analyzer.analyze(x.data(), x.size());
+  check(&first == &second, "Analyzer returns its own result");
+  check(second.f0.data() == f0, "Analyzer reuses f0");
+  check(second.spectrogram.data() == spectrogram, "Analyzer reuses sp");
+  check(same(second, copy), "Analyzer repeats its result");
+}
+
+// Every channel must get the result of Analyzer with one thread.
+void test_batch_analyzer(const std::vector<double>& x) {
+  std::vector<double> reversed(x.rbegin(), x.rend());
+  std::vector<double> quiet(x.size());
+  for (size_t i = 0; i < x.size(); i++) {
+    quiet[i] = 0.5 * x[i];
+  }
+  const double* channels[] = {x.data(), reversed.data(), quiet.data()};
+  for (const auto method : {wwopy::F0Method::dio, wwopy::F0Method::harvest}) {
+    wwopy::BatchAnalyzer batch(kFs, options(method), 4);
+    const auto& results =
+        batch.analyze(channels, std::size(channels), x.size());
+    check(results.size() == std::size(channels), "BatchAnalyzer size");
+    wwopy::Analyzer analyzer(kFs, options(method));
+    for (size_t i = 0; i < results.size(); i++) {
+      check(
+          same(results[i], analyzer.analyze(channels[i], x.size())),
+          "BatchAnalyzer channel"
+      );
+    }
+  }
+}
+
+// A strided signal is gathered around each block of frames and must give
+// the result of a contiguous copy. One with adjacent samples is read in
+// place.
+void test_strided_signals(const std::vector<double>& x) {
+  const auto analysis =
+      wwopy::Analyzer(kFs, options(wwopy::F0Method::dio)).analyze(
+          x.data(), x.size()
+      );
+  const size_t f0_length = analysis.f0.size();
+  // Frames a quarter of a sample off the grid, so that rounding the shifted
+  // positions to samples cannot tip over.
+  std::vector<double> temporal_positions(f0_length);
+  for (size_t i = 0; i < f0_length; i++) {
+    temporal_positions[i] = analysis.temporal_positions[i] + (0.25 / kFs);
+  }
+  const double* tp = temporal_positions.data();
+  const double* f0 = analysis.f0.data();
+  const CheapTrickOption cheaptrick_option =
+      wwopy::make_cheaptrick_option(kFs, {});
+  const int fft_size = cheaptrick_option.fft_size;
+  const D4COption d4c_option = wwopy::make_d4c_option({});
+  const auto run = [&](const wwopy::StridedSignals& signals) {
+    wwopy::Matrix result(3 * f0_length, (fft_size / 2) + 1);
+    wwopy::stonemask(signals, kFs, tp, &f0, f0_length, 2, result.row(0));
+    wwopy::cheaptrick(
+        signals, kFs, tp, &f0, f0_length, cheaptrick_option, std::nullopt, 2,
+        &result.row_pointers()[f0_length]
+    );
+    wwopy::d4c(
+        signals, kFs, tp, &f0, f0_length, fft_size, d4c_option, false, 2,
+        &result.row_pointers()[2 * f0_length]
+    );
+    return result;
+  };
+  const auto length = static_cast<std::ptrdiff_t>(x.size());
+  const auto expected = run({x.data(), 1, x.size(), 0, 1});
+  std::vector<double> stereo(2 * x.size());
+  for (size_t i = 0; i < x.size(); i++) {
+    stereo[2 * i] = x[i];
+    stereo[(2 * i) + 1] = -x[i];
+  }
+  check(
+      close(run({stereo.data(), 1, x.size(), 0, 2}), expected),
+      "interleaved channel"
+  );
+  std::vector<double> reversed(x.rbegin(), x.rend());
+  check(
+      close(run({&reversed[length - 1], 1, x.size(), 0, -1}), expected),
+      "reversed channel"
+  );
+  const double* signal = x.data();
+  wwopy::Matrix spectrogram(f0_length, (fft_size / 2) + 1);
+  wwopy::cheaptrick(
+      &signal, 1, x.size(), kFs, tp, &f0, f0_length, cheaptrick_option,
+      std::nullopt, 2, spectrogram.row_pointers()
+  );
+  check(
+      std::equal(
+          spectrogram.data(), spectrogram.data() + spectrogram.columns(),
+          expected.row(f0_length)
+      ),
+      "contiguous channel"
+  );
+}
+
+// append() used to size its row pointers by the spectrum length, so more
+// frames than bins overflowed them.
+void test_realtime_synthesizer_many_frames() {
+  const int fft_size = 64;
+  const size_t spectrum_length = (fft_size / 2) + 1;
+  const size_t frames = 4 * spectrum_length;
+  const std::vector<double> f0(frames, 150.0);
+  wwopy::Matrix spectrogram(frames, spectrum_length);
+  wwopy::Matrix aperiodicity(frames, spectrum_length);
+  for (size_t i = 0; i < frames * spectrum_length; i++) {
+    spectrogram.data()[i] = 1e-4;
+    aperiodicity.data()[i] = 0.5;
+  }
+  wwopy::RealtimeSynthesizer synthesizer(kFs, 5.0, fft_size, 64, 2);
+  check(
+      synthesizer.append(
+          f0.data(), frames, spectrogram.row_pointers(),
+          aperiodicity.row_pointers(), spectrum_length
+      ),
+      "RealtimeSynthesizer append"
+  );
+  std::vector<double> y(synthesizer.buffer_size());
+  size_t buffers = 0;
+  while (synthesizer.synthesis(y.data())) {
+    for (const double sample : y) {
+      check(std::isfinite(sample), "RealtimeSynthesizer output");
+    }
+    buffers++;
+  }
+  check(buffers > 0, "RealtimeSynthesizer buffers");
+}
+
+}  // namespace
+
+auto main() -> int {
+  const auto x = make_signal();
+  test_analyzer_matches_stages(x);
+  test_analyzer_n_threads(x);
+  test_analyzer_reuses_buffers(x);
+  test_batch_analyzer(x);
+  test_strided_signals(x);
+  test_realtime_synthesizer_many_frames();
+  if (failures != 0) {
+    std::printf("%d checks failed.\n", failures);
+    return 1;
+  }
+  std::printf("All checks passed.\n");
+  return 0;
+}
@@ -0,0 +1,80 @@
+from __future__ import annotations
+
+import asyncio
+import threading
+
+import numpy as np
+import pytest
+
+import wwopy
+
+
+def test_harvest(test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int]):
+    x, fs = test_wave
+
+    async def main():
+        return await asyncio.gather(*(wwopy.aio.harvest(x, fs) for _ in range(4)))
+
+    expected_temporal_positions, expected_f0, _frame_period = wwopy.harvest(x, fs)
+    for temporal_positions, f0, _frame_period in asyncio.run(main()):
+        np.testing.assert_array_equal(temporal_positions, expected_temporal_positions)
+        np.testing.assert_array_equal(f0, expected_f0)
+
+
+def test_analyze(test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int]):
+    x, fs = test_wave
+
+    async def main():
+        f0, spectrogram, aperiodicity, frame_period = await wwopy.aio.analyze(x, fs)
+        return await wwopy.aio.synthesis(
+            f0, spectrogram, aperiodicity, frame_period, fs
+        )
+
+    y = asyncio.run(main())
+    assert y.dtype == np.double
+    assert y.ndim == 1
+
+
+def test_error():
+    async def main():
+        await wwopy.aio.dio(np.empty(0, np.double), 0)
+
+    with pytest.raises(ValueError, match="samplerate"):
+        asyncio.run(main())
+
+
+def test_set_n_threads(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    wwopy.aio.set_n_threads(2)
+
+    async def main():
+        return await wwopy.aio.dio(x, fs)
+
+    _temporal_positions, f0, _frame_period = asyncio.run(main())
+    np.testing.assert_array_equal(f0, wwopy.dio(x, fs)[1])
+    wwopy.aio.set_n_threads()
+
+
+def test_task_pool_n_threads():
+    assert wwopy.wwopy_ext.TaskPool().n_threads == 1
+    assert wwopy.wwopy_ext.TaskPool(None).n_threads >= 1
+
+
+def test_task_pool_shutdown_from_task():
+    pool = wwopy.wwopy_ext.TaskPool(2)
+    done = threading.Event()
+    results = []
+
+    def callback(result: object, error: BaseException | None):
+        results.append((result, error))
+        done.set()
+
+    # Used to join the worker that runs the task from itself.
+    pool.submit(pool.shutdown, (), {}, callback)
+    assert done.wait(10)
+    assert results == [(None, None)]
+    with pytest.raises(RuntimeError, match="shut down"):
+        pool.submit(print, (), {}, callback)
+    pool.shutdown()
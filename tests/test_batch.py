@@ -0,0 +1,69 @@
+from __future__ import annotations
+
+import numpy as np
+import pytest
+
+import wwopy
+
+
+@pytest.fixture
+def batch(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+) -> np.ndarray[tuple[int, int], np.dtype[np.double]]:
+    x, _fs = test_wave
+    return np.stack([x, x[::-1].copy(), 0.5 * x])
+
+
+@pytest.mark.parametrize("estimator", [wwopy.dio, wwopy.harvest])
+def test_f0_batch(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    batch: np.ndarray[tuple[int, int], np.dtype[np.double]],
+    estimator,
+):
+    _x, fs = test_wave
+    temporal_positions, f0, frame_period = estimator(batch, fs, n_threads=3)
+    assert f0.shape == (batch.shape[0], temporal_positions.shape[0])
+    for channel, channel_f0 in zip(batch, f0):
+        expected = estimator(channel, fs)
+        np.testing.assert_array_equal(temporal_positions, expected[0])
+        np.testing.assert_array_equal(channel_f0, expected[1])
+        assert frame_period == expected[2]
+
+
+def test_analysis_batch(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    batch: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    _x, fs = test_wave
+    temporal_positions, f0, _frame_period = wwopy.dio(batch, fs)
+    refined_f0 = wwopy.stonemask(batch, fs, temporal_positions, f0, n_threads=4)
+    spectrogram, fft_size = wwopy.cheaptrick(
+        batch, fs, temporal_positions, refined_f0, n_threads=4
+    )
+    aperiodicity = wwopy.d4c(
+        batch, fs, temporal_positions, refined_f0, fft_size, n_threads=4
+    )
+    assert refined_f0.shape == f0.shape
+    assert spectrogram.shape == (*f0.shape, fft_size // 2 + 1)
+    assert aperiodicity.shape == spectrogram.shape
+    for i, channel in enumerate(batch):
+        expected_f0 = wwopy.stonemask(channel, fs, temporal_positions, f0[i])
+        np.testing.assert_array_equal(refined_f0[i], expected_f0)
+        expected_spectrogram, _ = wwopy.cheaptrick(
+            channel, fs, temporal_positions, expected_f0
+        )
+        np.testing.assert_array_equal(spectrogram[i], expected_spectrogram)
+        np.testing.assert_array_equal(
+            aperiodicity[i],
+            wwopy.d4c(channel, fs, temporal_positions, expected_f0, fft_size),
+        )
+
+
+def test_channel_mismatch(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    batch: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    _x, fs = test_wave
+    temporal_positions, f0, _frame_period = wwopy.dio(batch, fs)
+    with pytest.raises(ValueError, match="channels"):
+        wwopy.stonemask(batch, fs, temporal_positions, f0[:2])
@@ -0,0 +1,97 @@
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+import numpy as np
+import pytest
+
+import wwopy
+
+if TYPE_CHECKING:
+    from pathlib import Path
+
+
+def test_memory(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    cache = wwopy.cache.AnalysisCache()
+    temporal_positions, f0, frame_period = cache.harvest(x, fs)
+    expected_temporal_positions, expected_f0, _ = wwopy.harvest(x, fs)
+    np.testing.assert_array_equal(f0, expected_f0)
+    assert not f0.flags.writeable
+    assert cache.harvest(x.copy(), fs)[1] is f0
+    assert cache.harvest(x, fs, frame_period=10.0)[1] is not f0
+
+    spectrogram, fft_size = cache.cheaptrick(x, fs, temporal_positions, f0)
+    np.testing.assert_array_equal(
+        spectrogram,
+        wwopy.cheaptrick(x, fs, expected_temporal_positions, expected_f0)[0],
+    )
+    aperiodicity = cache.d4c(x, fs, temporal_positions, f0, fft_size)
+    assert cache.d4c(x, fs, temporal_positions, f0, fft_size) is aperiodicity
+    assert frame_period == 5.0
+
+
+def test_budget(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    _, f0, _ = wwopy.dio(x, fs)
+    cache = wwopy.cache.AnalysisCache(max_bytes=f0.nbytes * 2)
+    first = cache.dio(x, fs)
+    assert cache.nbytes == f0.nbytes * 2
+    cache.dio(x, fs, speed=2)
+    assert cache.nbytes <= f0.nbytes * 2
+    assert cache.dio(x, fs) is not first
+
+    cache.clear()
+    assert cache.nbytes == 0
+
+
+def test_directory(
+    tmp_path: Path,
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    _temporal_positions, f0, frame_period = wwopy.cache.AnalysisCache(
+        directory=tmp_path
+    ).harvest(x, fs)
+
+    cache = wwopy.cache.AnalysisCache(directory=tmp_path)
+    _, loaded_f0, loaded_frame_period = cache.harvest(x, fs)
+    assert isinstance(loaded_f0, np.memmap)
+    np.testing.assert_array_equal(loaded_f0, f0)
+    assert loaded_frame_period == frame_period
+
+
+def test_n_threads_is_not_keyed(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    cache = wwopy.cache.AnalysisCache()
+    temporal_positions, f0, _frame_period = cache.harvest(x, fs)
+    spectrogram, fft_size = cache.cheaptrick(x, fs, temporal_positions, f0)
+    assert (
+        cache.cheaptrick(x, fs, temporal_positions, f0, n_threads=2)[0] is spectrogram
+    )
+    aperiodicity = cache.d4c(x, fs, temporal_positions, f0, fft_size, n_threads=2)
+    assert cache.d4c(x, fs, temporal_positions, f0, fft_size) is aperiodicity
+
+
+def test_version_is_keyed(
+    monkeypatch: pytest.MonkeyPatch,
+    tmp_path: Path,
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    wwopy.cache.AnalysisCache(directory=tmp_path).harvest(x, fs)
+    # Results stored by another release are not loaded.
+    monkeypatch.setattr(wwopy.cache, "_version", "0.0.0")
+    _, f0, _ = wwopy.cache.AnalysisCache(directory=tmp_path).harvest(x, fs)
+    assert not isinstance(f0, np.memmap)
+
+
+def test_invalid():
+    with pytest.raises(ValueError, match="max_bytes"):
+        wwopy.cache.AnalysisCache(max_bytes=-1)
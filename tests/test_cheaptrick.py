@@ -65,3 +65,49 @@ def test_warning(
             x, fs, temporal_positions, f0, f0_floor=72.0, fft_size=fft_size
         )
     assert result_fft_size == fft_size
+
+
+@pytest.mark.parametrize("coded_dim", [None, 40])
+def test_n_threads(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    coded_dim: int | None,
+):
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = dio_result
+    expected, _fft_size = wwopy.cheaptrick(
+        x, fs, temporal_positions, f0, coded_dim=coded_dim, n_threads=1
+    )
+    # CheapTrick draws random noise. Blocks of frames must not depend on
+    # n_threads, and threads must not share the generator.
+    for _ in range(4):
+        spectrogram, _fft_size = wwopy.cheaptrick(
+            x, fs, temporal_positions, f0, coded_dim=coded_dim, n_threads=4
+        )
+        np.testing.assert_array_equal(spectrogram, expected)
+
+
+def test_frame_blocks(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+):
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = dio_result
+    assert len(f0) > 64
+    spectrogram, _fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0)
+    # Every block of 64 frames is one World call, which restarts the random
+    # generator. A call on the frames of one block gives the same result.
+    for begin in range(0, len(f0), 64):
+        block = slice(begin, begin + 64)
+        expected, _fft_size = wwopy.cheaptrick(
+            x, fs, temporal_positions[block], f0[block]
+        )
+        np.testing.assert_array_equal(spectrogram[block], expected)
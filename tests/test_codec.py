@@ -0,0 +1,114 @@
+from __future__ import annotations
+
+import numpy as np
+import pytest
+
+import wwopy
+
+
+def test_spectral_envelope(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+):
+    _x, fs = test_wave
+    spectrogram, fft_size = cheaptrick_result
+    coded = wwopy.code_spectral_envelope(spectrogram, fs, 40)
+    assert coded.shape == (spectrogram.shape[0], 40)
+    np.testing.assert_array_equal(
+        coded, wwopy.code_spectral_envelope(spectrogram, fs, 40, n_threads=1)
+    )
+    decoded = wwopy.decode_spectral_envelope(coded, fs, fft_size)
+    assert decoded.shape == spectrogram.shape
+    np.testing.assert_array_equal(
+        decoded, wwopy.decode_spectral_envelope(coded, fs, fft_size, n_threads=1)
+    )
+
+
+def test_cheaptrick_coded_dim(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = dio_result
+    spectrogram, fft_size = cheaptrick_result
+    expected = wwopy.code_spectral_envelope(spectrogram, fs, 40)
+    coded, coded_fft_size = wwopy.cheaptrick(
+        x, fs, temporal_positions, f0, coded_dim=40, n_threads=4
+    )
+    assert coded_fft_size == fft_size
+    np.testing.assert_allclose(coded, expected, rtol=1e-6, atol=1e-9)
+
+
+def test_empty():
+    empty_coded = np.empty((0, 40), np.double)
+    spectrogram = wwopy.decode_spectral_envelope(empty_coded, 44100, 2048)
+    assert spectrogram.shape == (0, 2048 // 2 + 1)
+    coded = wwopy.code_spectral_envelope(spectrogram, 44100, 40)
+    assert coded.shape == (0, 40)
+
+
+def test_aperiodicity(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+    d4c_result: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    _x, fs = test_wave
+    _spectrogram, fft_size = cheaptrick_result
+    coded = wwopy.code_aperiodicity(d4c_result, fs)
+    assert coded.shape[0] == d4c_result.shape[0]
+    assert coded.shape[1] < d4c_result.shape[1]
+    decoded = wwopy.decode_aperiodicity(coded, fs, fft_size)
+    assert decoded.shape == d4c_result.shape
+    # D4C interpolates its aperiodicity in dB between the same bands that
+    # are coded, so decoding restores it to within 1 dB.
+    error = np.abs(20 * np.log10(decoded) - 20 * np.log10(d4c_result))
+    assert error.max() <= 1.0
+
+
+def test_d4c_coded(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+    d4c_result: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    x, fs = test_wave
+    temporal_positions, f0, frame_period = dio_result
+    spectrogram, fft_size = cheaptrick_result
+    expected = wwopy.code_aperiodicity(d4c_result, fs)
+    coded = wwopy.d4c(x, fs, temporal_positions, f0, fft_size, coded=True, n_threads=4)
+    np.testing.assert_allclose(coded, expected, rtol=1e-6, atol=1e-9)
+
+    y_coded = wwopy.synthesis(f0, spectrogram, coded, frame_period, fs, coded=True)
+    decoded = wwopy.decode_aperiodicity(coded, fs, fft_size)
+    y = wwopy.synthesis(f0, spectrogram, decoded, frame_period, fs)
+    np.testing.assert_allclose(y_coded, y)
+
+
+def test_synthesis_coded_length(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+    d4c_result: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    _x, fs = test_wave
+    _temporal_positions, f0, frame_period = dio_result
+    spectrogram, _fft_size = cheaptrick_result
+    coded = wwopy.code_aperiodicity(d4c_result, fs)
+    # The width of the aperiodicity does not select the coded form.
+    with pytest.raises(ValueError, match="spectrogram and aperiodicity"):
+        wwopy.synthesis(f0, spectrogram, coded, frame_period, fs)
+    with pytest.raises(ValueError, match="coded aperiodicity"):
+        wwopy.synthesis(f0, spectrogram, d4c_result, frame_period, fs, coded=True)
@@ -0,0 +1,122 @@
+from __future__ import annotations
+
+import wave
+from typing import TYPE_CHECKING
+
+import numpy as np
+import pytest
+
+import wwopy
+
+if TYPE_CHECKING:
+    from pathlib import Path
+
+
+def _write_wav(
+    path: Path, x: np.ndarray[tuple[int], np.dtype[np.double]], fs: int
+) -> None:
+    path.parent.mkdir(parents=True, exist_ok=True)
+    with wave.open(str(path), "wb") as f:
+        f.setnchannels(1)
+        f.setsampwidth(2)
+        f.setframerate(fs)
+        f.writeframes((x * 2**15).astype("<i2").tobytes())
+
+
+def test_process_corpus(
+    tmp_path: Path,
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    names = ["a/1.wav", "a/2.wav", "b/1.wav"]
+    for name in names:
+        _write_wav(tmp_path / name, x, fs)
+    manifest = tmp_path / "manifest.txt"
+    manifest.write_text("\n".join(names))
+    out_dir = tmp_path / "out"
+
+    reports: list[wwopy.corpus.CorpusProgress] = []
+    result = wwopy.process_corpus(
+        manifest, out_dir, workers=2, queue_depth=1, progress=reports.append
+    )
+    assert result.done == 3
+    assert result.skipped == 0
+    assert result.audio_seconds == pytest.approx(3 * len(x) / fs)
+    assert len(reports) == 3
+
+    temporal_positions, f0, frame_period = wwopy.harvest(x, fs)
+    spectrogram, fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0)
+    with np.load(out_dir / "a/2.npz") as data:
+        np.testing.assert_array_equal(data["f0"], f0)
+        np.testing.assert_array_equal(data["spectrogram"], spectrogram)
+        np.testing.assert_array_equal(
+            data["aperiodicity"],
+            wwopy.d4c(x, fs, temporal_positions, f0, fft_size),
+        )
+        assert data["frame_period"] == frame_period
+        assert data["fs"] == fs
+
+    # Only the missing result is computed again.
+    (out_dir / "b/1.npz").unlink()
+    result = wwopy.process_corpus(manifest, out_dir, progress=False)
+    assert result.done == 1
+    assert result.skipped == 2
+    assert (out_dir / "b/1.npz").exists()
+
+
+def test_process_corpus_error(
+    tmp_path: Path,
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    _write_wav(tmp_path / "good.wav", x, fs)
+    (tmp_path / "bad.wav").write_bytes(b"not a wave file")
+    with pytest.raises(Exception, match="RIFF"):
+        wwopy.process_corpus(
+            [tmp_path / "good.wav", tmp_path / "bad.wav"],
+            tmp_path / "out",
+            progress=False,
+        )
+    assert not list((tmp_path / "out").glob("*.tmp"))
+
+
+def test_process_corpus_options(
+    tmp_path: Path,
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    _write_wav(tmp_path / "1.wav", x, fs)
+    out_dir = tmp_path / "out"
+    wwopy.process_corpus([tmp_path / "1.wav"], out_dir, progress=False)
+    result = wwopy.process_corpus(
+        [tmp_path / "1.wav"], out_dir, frame_period=10.0, progress=False
+    )
+    # A result computed with other options is not reused.
+    assert result.done == 1
+    assert result.skipped == 0
+    with np.load(out_dir / "1.npz") as data:
+        assert data["frame_period"] == 10.0
+    result = wwopy.process_corpus(
+        [tmp_path / "1.wav"], out_dir, frame_period=10.0, progress=False
+    )
+    assert result.skipped == 1
+
+
+def test_process_corpus_progress_error(
+    tmp_path: Path,
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    paths = [tmp_path / f"{i}.wav" for i in range(4)]
+    for path in paths:
+        _write_wav(path, x, fs)
+
+    def progress(_state: wwopy.corpus.CorpusProgress) -> None:
+        msg = "progress failed"
+        raise RuntimeError(msg)
+
+    # The error stops the run instead of leaving the reader blocked.
+    with pytest.raises(RuntimeError, match="progress failed"):
+        wwopy.process_corpus(
+            paths, tmp_path / "out", workers=1, queue_depth=1, progress=progress
+        )
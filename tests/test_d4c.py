@@ -1,4 +1,7 @@
+from __future__ import annotations
+
 import numpy as np
+import pytest
 
 import wwopy
 
@@ -13,3 +16,51 @@ def test_empty():
     )
     assert aperiodicity.dtype == np.double
     assert aperiodicity.shape == (0, fft_size // 2 + 1)
+
+
+@pytest.mark.parametrize("coded", [False, True])
+def test_n_threads(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+    coded: bool,
+):
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = dio_result
+    _spectrogram, fft_size = cheaptrick_result
+    expected = wwopy.d4c(
+        x, fs, temporal_positions, f0, fft_size, coded=coded, n_threads=1
+    )
+    # D4C draws random noise. Blocks of frames must not depend on
+    # n_threads, and threads must not share the generator.
+    for _ in range(4):
+        aperiodicity = wwopy.d4c(
+            x, fs, temporal_positions, f0, fft_size, coded=coded, n_threads=4
+        )
+        np.testing.assert_array_equal(aperiodicity, expected)
+
+
+def test_frame_blocks(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = dio_result
+    _spectrogram, fft_size = cheaptrick_result
+    assert len(f0) > 64
+    aperiodicity = wwopy.d4c(x, fs, temporal_positions, f0, fft_size)
+    # Every block of 64 frames is one World call, which restarts the random
+    # generator. A call on the frames of one block gives the same result.
+    for begin in range(0, len(f0), 64):
+        block = slice(begin, begin + 64)
+        expected = wwopy.d4c(x, fs, temporal_positions[block], f0[block], fft_size)
+        np.testing.assert_array_equal(aperiodicity[block], expected)
@@ -0,0 +1,48 @@
+from __future__ import annotations
+
+import numpy as np
+import pytest
+
+import wwopy
+
+
+def test_empty():
+    empty_x = np.empty(0, np.double)
+    temporal_positions, f0, _frame_period = wwopy.dio_harvest(empty_x, 44100)
+    assert temporal_positions.shape == (0,)
+    assert f0.shape == (0,)
+
+
+def test_dio_harvest(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+):
+    x, fs = test_wave
+    dio_temporal_positions, dio_f0, _frame_period = dio_result
+    refined_f0 = wwopy.stonemask(x, fs, dio_temporal_positions, dio_f0)
+    _, harvest_f0, _ = wwopy.harvest(x, fs)
+
+    temporal_positions, f0, _frame_period = wwopy.dio_harvest(x, fs)
+    np.testing.assert_array_equal(temporal_positions, dio_temporal_positions)
+
+    def agreement(f0: np.ndarray[tuple[int], np.dtype[np.double]]) -> float:
+        return float(np.mean(np.isclose(f0, harvest_f0, rtol=0.05)))
+
+    assert agreement(f0) >= agreement(refined_f0)
+
+    _, f0_threads, _ = wwopy.dio_harvest(x, fs, n_threads=4)
+    np.testing.assert_array_equal(f0_threads, f0)
+
+
+def test_invalid(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    with pytest.raises(ValueError, match="threshold"):
+        wwopy.dio_harvest(x, fs, threshold=0.0)
+    with pytest.raises(ValueError, match="padding"):
+        wwopy.dio_harvest(x, fs, padding=-1.0)
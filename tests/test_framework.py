@@ -0,0 +1,70 @@
+from __future__ import annotations
+
+import numpy as np
+import pytest
+
+import wwopy
+
+
+def test_invalid_framework(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    with pytest.raises(ValueError, match="framework"):
+        wwopy.dio(x, fs, framework="pandas")
+
+
+def test_dlpack(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+):
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = dio_result
+    spectrogram, _fft_size = wwopy.cheaptrick(
+        x, fs, temporal_positions, f0, framework="dlpack"
+    )
+    # The result implements the DLPack protocol for CPU memory.
+    assert spectrogram.__dlpack_device__() == (1, 0)
+    np.testing.assert_array_equal(
+        np.from_dlpack(spectrogram),
+        wwopy.cheaptrick(x, fs, temporal_positions, f0)[0],
+    )
+
+
+def test_torch(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    torch = pytest.importorskip("torch")
+    x, fs = test_wave
+    x_tensor = torch.from_numpy(x)
+    temporal_positions, f0, frame_period = wwopy.harvest(
+        x_tensor, fs, framework="torch"
+    )
+    assert isinstance(f0, torch.Tensor)
+    assert f0.dtype == torch.float64
+    expected_temporal_positions, expected_f0, _ = wwopy.harvest(x, fs)
+    np.testing.assert_array_equal(f0.numpy(), expected_f0)
+
+    spectrogram, fft_size = wwopy.cheaptrick(
+        x_tensor, fs, temporal_positions, f0, framework="torch"
+    )
+    aperiodicity = wwopy.d4c(
+        x_tensor, fs, temporal_positions, f0, fft_size, framework="torch"
+    )
+    assert isinstance(spectrogram, torch.Tensor)
+    assert isinstance(aperiodicity, torch.Tensor)
+    np.testing.assert_array_equal(
+        spectrogram.numpy(),
+        wwopy.cheaptrick(x, fs, expected_temporal_positions, expected_f0)[0],
+    )
+
+    y = wwopy.synthesis(f0, spectrogram, aperiodicity, frame_period, fs)
+    assert isinstance(y, np.ndarray)
+    y_tensor = wwopy.synthesis(
+        f0, spectrogram, aperiodicity, frame_period, fs, framework="torch"
+    )
+    np.testing.assert_array_equal(y_tensor.numpy(), y)
@@ -1,4 +1,7 @@
+from __future__ import annotations
+
 import numpy as np
+import pytest
 
 import wwopy
 
@@ -10,3 +13,12 @@ def test_empty():
     assert temporal_positions.shape == (0,)
     assert f0.dtype == np.double
     assert f0.shape == (0,)
+
+
+def test_n_threads_needs_channels(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    # A single signal is one Harvest call, so only batches take n_threads.
+    with pytest.raises(TypeError):
+        wwopy.harvest(x, fs, n_threads=2)  # type: ignore[call-overload]
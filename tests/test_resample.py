@@ -0,0 +1,43 @@
+from __future__ import annotations
+
+import numpy as np
+import pytest
+
+import wwopy
+
+
+def test_empty():
+    y = wwopy.resample(np.empty(0, np.double), 48000, 16000)
+    assert y.dtype == np.double
+    assert y.shape == (0,)
+
+
+@pytest.mark.parametrize(
+    ("fs", "target_fs"),
+    # 16000 to 16001 has more phases than are tabulated.
+    [(48000, 16000), (44100, 16000), (16000, 44100), (16000, 16001)],
+)
+def test_sine(fs: int, target_fs: int):
+    frequency = 1000.0
+    x = np.sin(2 * np.pi * frequency * np.arange(fs) / fs)
+    y = wwopy.resample(x, fs, target_fs)
+    assert y.shape == (target_fs,)
+    expected = np.sin(2 * np.pi * frequency * np.arange(target_fs) / target_fs)
+    # The kernel reaches past the signal near both ends.
+    middle = slice(target_fs // 10, -target_fs // 10)
+    np.testing.assert_allclose(y[middle], expected[middle], atol=1e-4)
+    np.testing.assert_array_equal(wwopy.resample(x, fs, target_fs, n_threads=1), y)
+
+
+def test_stopband():
+    fs = 48000
+    x = np.sin(2 * np.pi * 12000.0 * np.arange(fs) / fs)
+    y = wwopy.resample(x, fs, 16000)
+    assert np.max(np.abs(y[1600:-1600])) < 1e-3
+
+
+def test_same_fs(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    np.testing.assert_array_equal(wwopy.resample(x, fs, fs), x)
@@ -1,3 +1,5 @@
+from __future__ import annotations
+
 import numpy as np
 
 import wwopy
@@ -10,3 +12,21 @@ def test_empty():
     f0 = wwopy.stonemask(empty_x, 44100, empty_temporal_positions, empty_f0)
     assert f0.dtype == np.double
     assert f0.shape == (0,)
+
+
+def test_n_threads(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+):
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = dio_result
+    expected = wwopy.stonemask(x, fs, temporal_positions, f0)
+    refined_f0 = wwopy.stonemask(x, fs, temporal_positions, f0, n_threads=4)
+    np.testing.assert_array_equal(refined_f0, expected)
+    # None uses all hardware threads.
+    refined_f0 = wwopy.stonemask(x, fs, temporal_positions, f0, n_threads=None)
+    np.testing.assert_array_equal(refined_f0, expected)
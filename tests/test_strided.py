@@ -0,0 +1,93 @@
+from __future__ import annotations
+
+import numpy as np
+
+import wwopy
+
+
+def test_interleaved_channel(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    stereo = np.stack([x, -x], axis=1)
+    left = stereo[:, 0]
+    assert not left.flags.c_contiguous
+    temporal_positions, f0, _frame_period = wwopy.harvest(left, fs)
+    expected_temporal_positions, expected_f0, _ = wwopy.harvest(x, fs)
+    np.testing.assert_array_equal(f0, expected_f0)
+
+    refined_f0 = wwopy.stonemask(left, fs, temporal_positions, f0)
+    # A strided signal is read through shifted temporal positions, and
+    # StoneMask windows depend on the exact position.
+    np.testing.assert_allclose(
+        refined_f0,
+        wwopy.stonemask(x, fs, expected_temporal_positions, expected_f0),
+        rtol=1e-12,
+    )
+    spectrogram, fft_size = wwopy.cheaptrick(left, fs, temporal_positions, f0)
+    np.testing.assert_array_equal(
+        spectrogram,
+        wwopy.cheaptrick(x, fs, expected_temporal_positions, expected_f0)[0],
+    )
+    np.testing.assert_array_equal(
+        wwopy.d4c(left, fs, temporal_positions, f0, fft_size),
+        wwopy.d4c(x, fs, expected_temporal_positions, expected_f0, fft_size),
+    )
+
+
+def test_strided_batch(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    x, fs = test_wave
+    # (channels, samples) view of interleaved samples.
+    batch = np.stack([x, x[::-1]], axis=1).T
+    assert not batch.flags.c_contiguous
+    _temporal_positions, f0, _frame_period = wwopy.dio(batch, fs)
+    np.testing.assert_array_equal(f0, wwopy.dio(np.ascontiguousarray(batch), fs)[1])
+
+
+def test_strided_parameters(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+    d4c_result: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    _x, fs = test_wave
+    _temporal_positions, f0, frame_period = dio_result
+    spectrogram, _fft_size = cheaptrick_result
+    # Every other frame, and bins stored with a column stride of 2.
+    f0_view = f0[::2]
+    spectrogram_view = np.repeat(spectrogram[::2], 2, axis=1)[:, ::2]
+    aperiodicity_view = np.repeat(d4c_result[::2], 2, axis=1)[:, ::2]
+    f0_copy = f0_view.copy()
+    spectrogram_copy = spectrogram_view.copy()
+    aperiodicity_copy = aperiodicity_view.copy()
+
+    np.testing.assert_array_equal(
+        wwopy.synthesis(
+            f0_view, spectrogram_view, aperiodicity_view, frame_period * 2, fs
+        ),
+        wwopy.synthesis(
+            f0_copy, spectrogram_copy, aperiodicity_copy, frame_period * 2, fs
+        ),
+    )
+    np.testing.assert_array_equal(
+        wwopy.code_spectral_envelope(spectrogram_view, fs, 32),
+        wwopy.code_spectral_envelope(spectrogram_copy, fs, 32),
+    )
+    np.testing.assert_array_equal(
+        wwopy.pitch_shift(f0_view, 1.5), wwopy.pitch_shift(f0_copy, 1.5)
+    )
+    np.testing.assert_array_equal(
+        wwopy.warp_frequency(spectrogram_view, 1.1),
+        wwopy.warp_frequency(spectrogram_copy, 1.1),
+    )
+    for result, expected in zip(
+        wwopy.time_stretch(f0_view, spectrogram_view, aperiodicity_view, 1.3),
+        wwopy.time_stretch(f0_copy, spectrogram_copy, aperiodicity_copy, 1.3),
+    ):
+        np.testing.assert_array_equal(result, expected)
@@ -1,5 +1,7 @@
 from __future__ import annotations
 
+import threading
+
 import numpy as np
 
 import wwopy
@@ -30,3 +32,60 @@ def test_multi_append(
             y = np.concatenate((y, out))
         if synthesizer.locked():
             break
+
+
+def test_concurrent_use(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+    d4c_result: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    _x, fs = test_wave
+    _temporal_positions, f0, frame_period = dio_result
+    spectrogram, fft_size = cheaptrick_result
+    synthesizer = wwopy.RealtimeSynthesizer(fs, frame_period, fft_size, 64, 8)
+
+    def producer():
+        i = 0
+        for _ in range(len(f0) * 4):
+            if i == len(f0) or synthesizer.locked():
+                break
+            if synthesizer.append(
+                f0[i : i + 1], spectrogram[i : i + 1], d4c_result[i : i + 1]
+            ):
+                i += 1
+
+    def consumer():
+        for _ in range(len(f0)):
+            out = synthesizer.synthesis()
+            if out is not None:
+                assert out.shape == (64,)
+
+    threads = [threading.Thread(target=producer)] + [
+        threading.Thread(target=consumer) for _ in range(3)
+    ]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+
+def test_append_more_frames_than_bins():
+    """append() used to size its row pointers by the number of bins."""
+    fs = 16000
+    fft_size = 64
+    frames = 4 * (fft_size // 2 + 1)
+    f0 = np.full(frames, 150.0)
+    spectrogram = np.full((frames, fft_size // 2 + 1), 1e-4)
+    aperiodicity = np.full_like(spectrogram, 0.5)
+    synthesizer = wwopy.RealtimeSynthesizer(fs, 5.0, fft_size, 64, 2)
+    assert synthesizer.append(f0, spectrogram, aperiodicity)
+    buffers = []
+    while (out := synthesizer.synthesis()) is not None:
+        buffers.append(out)
+    assert buffers
+    assert np.isfinite(np.concatenate(buffers)).all()
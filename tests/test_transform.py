@@ -0,0 +1,94 @@
+from __future__ import annotations
+
+import numpy as np
+import pytest
+
+import wwopy
+
+
+def test_pitch_shift(
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+):
+    _temporal_positions, f0, _frame_period = dio_result
+    shifted = wwopy.pitch_shift(f0, 1.5)
+    np.testing.assert_array_equal(shifted, f0 * 1.5)
+    assert np.all(shifted[f0 == 0] == 0)
+
+
+def test_pitch_shift_inplace(
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+):
+    _temporal_positions, f0, _frame_period = dio_result
+    expected = f0 * 0.5
+    result = wwopy.pitch_shift(f0, 0.5, out=f0, n_threads=3)
+    np.testing.assert_array_equal(f0, expected)
+    assert np.shares_memory(result, f0)
+
+
+def test_warp_frequency(
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+):
+    spectrogram, _fft_size = cheaptrick_result
+    ratio = 1.2
+    bins = np.arange(spectrogram.shape[1], dtype=np.double)
+    expected = np.stack([np.interp(bins / ratio, bins, row) for row in spectrogram])
+    result = wwopy.warp_frequency(spectrogram, ratio)
+    np.testing.assert_allclose(result, expected, rtol=1e-12)
+
+    copied = spectrogram.copy()
+    wwopy.warp_frequency(copied, ratio, out=copied, n_threads=2)
+    np.testing.assert_array_equal(copied, result)
+
+
+def test_warp_frequency_invalid_out(
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+):
+    spectrogram, _fft_size = cheaptrick_result
+    with pytest.raises(ValueError, match="shape"):
+        wwopy.warp_frequency(spectrogram, 1.0, out=spectrogram[1:])
+    with pytest.raises(ValueError, match="C-contiguous"):
+        wwopy.warp_frequency(
+            spectrogram, 1.0, out=np.empty_like(spectrogram, order="F")
+        )
+
+
+def test_time_stretch(
+    dio_result: tuple[
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        np.ndarray[tuple[int], np.dtype[np.double]],
+        float,
+    ],
+    cheaptrick_result: tuple[np.ndarray[tuple[int, int], np.dtype[np.double]], int],
+    d4c_result: np.ndarray[tuple[int, int], np.dtype[np.double]],
+):
+    _temporal_positions, f0, _frame_period = dio_result
+    spectrogram, _fft_size = cheaptrick_result
+    f0_out, sp_out, ap_out = wwopy.time_stretch(f0, spectrogram, d4c_result, 2.0)
+    assert f0_out.shape == ((len(f0) - 1) * 2 + 1,)
+    assert sp_out.shape == (len(f0_out), spectrogram.shape[1])
+    assert ap_out.shape == (len(f0_out), spectrogram.shape[1])
+    np.testing.assert_array_equal(f0_out[::2], f0)
+    np.testing.assert_array_equal(sp_out[::2], spectrogram)
+    np.testing.assert_allclose(sp_out[1::2], (spectrogram[:-1] + spectrogram[1:]) / 2)
+    np.testing.assert_array_equal(ap_out[::2], d4c_result)
+
+
+def test_empty():
+    empty_f0 = np.empty(0, np.double)
+    empty_spectrogram = np.empty((0, 1025), np.double)
+    assert wwopy.pitch_shift(empty_f0, 2.0).shape == (0,)
+    assert wwopy.warp_frequency(empty_spectrogram, 2.0).shape == (0, 1025)
+    f0, spectrogram, aperiodicity = wwopy.time_stretch(
+        empty_f0, empty_spectrogram, empty_spectrogram, 2.0
+    )
+    assert f0.shape == (0,)
+    assert spectrogram.shape == (0, 1025)
+    assert aperiodicity.shape == (0, 1025)
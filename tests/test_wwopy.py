@@ -1,6 +1,11 @@
 from __future__ import annotations
 
+import sys
+import sysconfig
+from concurrent.futures import ThreadPoolExecutor
+
 import numpy as np
+import pytest
 
 import wwopy
 
@@ -54,3 +59,31 @@ def test_realtimesynthesizer(
     y = np.empty(0, np.double)
     while (out := synthesizer.synthesis()) is not None:
         y = np.concatenate((y, out))
+
+
+def test_concurrent_calls(
+    test_wave: tuple[np.ndarray[tuple[int], np.dtype[np.double]], int],
+):
+    # CheapTrick and D4C draw random noise. Calls from several Python threads
+    # must not share the generator.
+    x, fs = test_wave
+    temporal_positions, f0, _frame_period = wwopy.harvest(x, fs)
+
+    def analyze(_: int) -> tuple[np.ndarray, np.ndarray]:
+        spectrogram, fft_size = wwopy.cheaptrick(x, fs, temporal_positions, f0)
+        return spectrogram, wwopy.d4c(x, fs, temporal_positions, f0, fft_size)
+
+    expected_spectrogram, expected_aperiodicity = analyze(0)
+    with ThreadPoolExecutor(4) as executor:
+        for spectrogram, aperiodicity in executor.map(analyze, range(8)):
+            np.testing.assert_array_equal(spectrogram, expected_spectrogram)
+            np.testing.assert_array_equal(aperiodicity, expected_aperiodicity)
+
+
+@pytest.mark.skipif(
+    not sysconfig.get_config_var("Py_GIL_DISABLED"),
+    reason="Requires free-threaded Python.",
+)
+def test_gil_not_enabled():
+    # Importing a module that does not support free-threading enables the GIL.
+    assert not sys._is_gil_enabled()  # type: ignore[attr-defined]